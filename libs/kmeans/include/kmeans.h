@@ -17,10 +17,20 @@
 /// \file kmeans.h
 ///
 /// Assign class to each entry basing on k-means.
+/// Calculation is performed by scDenseKMeans (see kmeans_dense.h), which
+/// reads items directly from scDataNode - input is not copied.
+/// One-dimensional input is solved exactly by scKMeans1D (see kmeans_1d.h),
+/// classes are then numbered in ascending order of values.
+/// Input can be also saved once to a matrix file (see kmeans_io.h) and used
+/// from there directly, without building scDataNode tree.
 
 // ----------------------------------------------------------------------------
 // Headers
 // ----------------------------------------------------------------------------
+#include <vector>
+
+#include "base/rand.h"
+
 #include "sc/dtypes.h"
 
 // ----------------------------------------------------------------------------
@@ -40,13 +50,24 @@
 // ----------------------------------------------------------------------------
 class scKMeansCalculator {
 public:
+  scKMeansCalculator();
+  /// generator used for initialization of engines (not owned), global one if not set
+  void setRandomGenerator(scRandomGenerator *value);
   void execute(const scDataNode &inputVector, scDataNode &output, uint classCount = 5, uint stepLimit = 5);
+  /// Run k-means restartCount times in parallel, output classes of run with lowest inertia.
+  /// Inertia of each run is returned in runInertia when given.
+  /// 1-D input is solved exactly as in execute(), runInertia has then one value.
+  void executeRestarts(const scDataNode &inputVector, scDataNode &output, uint restartCount, 
+    uint classCount = 5, uint stepLimit = 5, std::vector<double> *runInertia = NULL);
+  /// Same as execute() for input stored in matrix file, file is memory-mapped and used in place
+  void executeFile(const scString &fileName, scDataNode &output, uint classCount = 5, uint stepLimit = 5);
+  /// Save input to matrix file, values are stored after input filter, as used by execute()
+  void exportInput(const scDataNode &inputVector, const scString &fileName, bool useFloat = false);
 protected:  
-  void initAvg(const scDataNode &inputVector, uint classCount, scDataNode &classAvg);
-  uint updateAvg(const scDataNode &inputVector, const scDataNode &itemClassList, scDataNode &classAvg);
-  void updateItemClass(const scDataNode &inputVector, const scDataNode &classAvg, scDataNode &itemClassList);
-  void prepareInputVector(const scDataNode &inputVector, scDataNode &output);
+  uint getInputDimCount(const scDataNode &inputVector);
+  void prepareOutput(const std::vector<uint> &itemClass, scDataNode &output);
 protected:
+  scRandomGenerator *m_randomSource;
 };
 
 #endif // _KMEANS_H__
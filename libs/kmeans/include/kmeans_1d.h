@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_1d.h
+// Project:     scLib
+// Purpose:     Exact k-means for one-dimensional input.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _KMEANS_1D_H__
+#define _KMEANS_1D_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file kmeans_1d.h
+///
+/// Optimal (minimal within-class sum of squares) clustering of values.
+/// Values are sorted and merged into distinct ones, then classes are found
+/// by dynamic programming (as in Ckmeans.1d.dp). Each row of DP table is
+/// filled by SMAWK over monotone split points, so total cost is
+/// O(n log n + k m), where m is number of distinct values.
+/// DP keeps k x m split points.
+/// Result is deterministic, classes are numbered in ascending order of
+/// their averages.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+
+//sc
+#include "sc/alg/kmeans_dense.h"
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Exact 1-D k-means on T (double or float) values
+template < class T >
+class scKMeans1D {
+public:
+  // -- create
+  scKMeans1D();
+  // -- properties
+  /// number of classes, limited by number of distinct values; 0 = one class per distinct value
+  void setClassCount(uint value);
+  /// transform applied to each value when it is read, NULL = none (default), not owned
+  void setTransform(const scKMeansFeatureTransform *value);
+  // -- run
+  /// Calculate class for each item, itemClass needs space for itemCount values.
+  /// Returns number of classes, 0 if there is nothing to do or input contains
+  /// values which are not finite (use iterative engine in such case).
+  uint execute(const T *input, uint itemCount, uint *itemClass);
+  uint execute(const scKMeansItemReader &input, uint itemCount, uint *itemClass);
+  // -- results
+  /// class averages in ascending order
+  const std::vector<double> &getClassAvg() const;
+  /// within-class sum of squares
+  double getInertia() const;
+protected:
+  uint run(uint itemCount, uint *itemClass);
+  double loadValue(uint itemIdx) const;
+  bool prepareValues();
+  void prepareSums();
+  double calcCost(uint beginPos, uint endPos) const;
+  double calcSplitCost(uint splitPos, uint endPos) const;
+  void fillRow(uint rowIdx, const std::vector<uint> &rows, const std::vector<uint> &cols);
+  void findClasses();
+  void updateItemClass(uint *itemClass) const;
+protected:
+  // config
+  uint m_classCount;
+  const scKMeansFeatureTransform *m_transform;
+  // input
+  const T *m_input;
+  const scKMeansItemReader *m_reader;
+  uint m_itemCount;
+  // state
+  uint m_realClassCount;
+  double m_shift;
+  double m_inertia;
+  std::vector<double> m_values;
+  std::vector<double> m_weights;
+  std::vector<double> m_sumW;
+  std::vector<double> m_sumX;
+  std::vector<double> m_sumX2;
+  std::vector<double> m_prevCost;
+  std::vector<double> m_currCost;
+  std::vector<uint> m_split;
+  std::vector<double> m_classUpper;
+  std::vector<double> m_classAvg;
+};
+
+#endif // _KMEANS_1D_H__
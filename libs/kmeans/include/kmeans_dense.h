@@ -0,0 +1,303 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_dense.h
+// Project:     scLib
+// Purpose:     Clustering using k-means on dense row-major matrices.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _KMEANS_DENSE_H__
+#define _KMEANS_DENSE_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file kmeans_dense.h
+///
+/// Assign class to each row of a contiguous matrix basing on k-means.
+/// Input is accessed in place (pointer + item count + dimension count),
+/// coordinates are converted to double only when they are read.
+/// Other input layouts can be used through scKMeansItemReader and optional
+/// feature transform is applied to each item when it is loaded.
+/// Quantized input (signed char codes) is decoded with per-dimension scale
+/// and offset, see kmeans_quant.h.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+#include "base/rand.h"
+
+//sc
+#include "sc/alg/kmeans_simd.h"
+#include "sc/alg/kmeans_transform.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+/// Skipping of distance calculations using triangle inequality or k-d tree.
+/// Classes assigned are the same as without acceleration.
+enum scKMeansAccelMode {
+  kam_none,     ///< full distance sweep for each item
+  kam_hamerly,  ///< one lower bound per item
+  kam_elkan,    ///< one lower bound per item and class (itemCount x classCount values), updated when read
+  kam_kdtree    ///< filtering on k-d tree built once over input, for low dimension count (2-8)
+};
+
+/// Selection of initial class averages
+enum scKMeansInitMode {
+  kim_random,     ///< distinct random items (default, as in scKMeansCalculator)
+  kim_plus_plus,  ///< k-means++
+  kim_parallel    ///< k-means|| - oversampling in few rounds, then weighted k-means++
+};
+
+/// Counters collected in each step
+struct scKMeansStepStats {
+  uint64 distanceCount; ///< item-to-class distances calculated
+  uint64 skippedCount;  ///< item-to-class distances skipped
+  uint changedCount;    ///< items which changed class
+};
+
+// ----------------------------------------------------------------------------
+// Forward class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint KMEANS_DEF_CLASS_COUNT = 5;
+const uint KMEANS_DEF_STEP_LIMIT = 5;
+// minimal number of items processed by one worker in one block
+const uint KMEANS_MIN_BLOCK_SIZE = 4096;
+// limits for number of blocks and for size of per-block partial sums (in values)
+const uint KMEANS_MAX_BLOCK_COUNT = 256;
+const uint KMEANS_MAX_BLOCK_SUMS_SIZE = 4 * 1024 * 1024;
+const uint KMEANS_DEF_INIT_ROUND_COUNT = 5;
+// relative safety margin for bound tests, covers rounding of sqrt and drift
+const double KMEANS_BOUND_MARGIN = 1.0E-9;
+// relative difference between kernel and exact distance, per dimension
+const double KMEANS_TIE_MARGIN_PER_DIM = 1.0E-15;
+// k-d tree: maximal number of items in leaf and maximal depth (deeper nodes are leaves)
+const uint KMEANS_TREE_LEAF_SIZE = 32;
+const uint KMEANS_TREE_MAX_DEPTH = 64;
+// k-d tree node with items in more than one class
+const uint KMEANS_TREE_MIXED = 0xffffffff;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Random access to items of input not stored as row-major matrix.
+/// Must be safe to call from several threads when more than one is used.
+class scKMeansItemReader {
+public:
+  virtual ~scKMeansItemReader() {}
+  /// Copy dimCount coordinates of item to output
+  virtual void readItem(uint itemIdx, double *output) const = 0;
+};
+
+/// k-means engine working on row-major buffer of T (double, float or signed char).
+/// Coordinates are converted to double when loaded, sums are always in double.
+/// Produces the same classes as scKMeansCalculator for the same input.
+/// Distances are calculated by vector kernels from kmeans_simd.h.
+///
+/// Items are processed in blocks, each block assigns its items and sums them
+/// into own per-class partial sums, which are merged in block order.
+/// Block layout depends only on input size, so when seed is set (or more than
+/// one thread is used) the result does not depend on number of threads.
+///
+/// With kam_kdtree a k-d tree (midpoint splits of widest dimension) is built
+/// once over input, each node keeps bounding box and sum of its items.
+/// In each step classes are filtered per node (Kanungo et al.): a class is
+/// dropped when it is farther than the class closest to cell center from
+/// the cell vertex in its direction. Node with one class left is assigned
+/// as a whole and its sum goes directly to class sums. Subtrees from fixed
+/// frontier (one per block) are processed in parallel. Item classes of
+/// whole nodes are written once, after last step. Items are visited in tree
+/// order, so ties are always broken by per-item hash (as with seed set), also
+/// when global generator is used for initialization.
+template < class T >
+class scDenseKMeans {
+public:
+  // -- create
+  scDenseKMeans();
+  // -- properties
+  /// number of classes, 0 = one class per item
+  void setClassCount(uint value);
+  void setStepLimit(uint value);
+  /// number of worker threads, 0 = OpenMP default, 1 = no threading (default)
+  void setThreadCount(uint value);
+  /// makes initialization and tie-breaks reproducible
+  void setSeed(uint64 value);
+  /// Generator which gives run seed when seed is not set (not owned),
+  /// run is then reproducible for the same state of generator.
+  void setRandomGenerator(scRandomGenerator *value);
+  /// select distance kernel, by default best one supported by CPU is used
+  void setSimdLevel(scKMeansSimdLevel value);
+  void setAccelMode(scKMeansAccelMode value);
+  void setInitMode(scKMeansInitMode value);
+  /// number of k-means|| sampling rounds
+  void setInitRoundCount(uint value);
+  /// expected number of items sampled in one k-means|| round, 0 = 2 * classCount
+  void setInitOversampling(double value);
+  /// transform applied to each item when it is read, NULL = none (default), not owned
+  void setTransform(const scKMeansFeatureTransform *value);
+  /// Decode T input as value * scale[k] + offset[k] (before transform), used for
+  /// quantized input. Empty vectors = no decoding (default). Not used for reader input.
+  void setInputScale(const std::vector<double> &scale, const std::vector<double> &offset);
+  /// Keep class sums between steps and update them only for items which changed class.
+  /// With kam_hamerly or kam_elkan items which keep their class are not even read,
+  /// so late steps cost O(1) bound test per item plus O(moved items x dim) for sums
+  /// (kam_none still calculates all distances). Sums are updated in different order
+  /// than in full recalculation, so averages can differ in last bits.
+  /// Ignored with kam_kdtree, which sums whole nodes anyway.
+  void setIncrementalUpdate(bool value);
+  /// Class is treated as moved (calculation continues) only when its average
+  /// moves by more than value x class space in some dimension, 0 = any move (default)
+  void setTolerance(double value);
+  // -- run
+  /// Calculate class for each item, itemClass needs space for itemCount values.
+  /// Returns number of classes really used (0 when there is nothing to do).
+  uint execute(const T *input, uint itemCount, uint dimCount, uint *itemClass);
+  /// Same as above for items read by reader
+  uint execute(const scKMeansItemReader &input, uint itemCount, uint dimCount, uint *itemClass);
+  // -- results
+  uint getStepCount() const;
+  /// class averages, classCount rows of dimCount values
+  const std::vector<double> &getClassAvg() const;
+  /// counters for each step performed
+  const std::vector<scKMeansStepStats> &getStepStats() const;
+  /// Within-class sum of squares (not scaled by class space) for classes
+  /// returned by last execute(), input must be still available
+  double calcInertia(const uint *itemClass) const;
+protected:
+  uint run(uint itemCount, uint dimCount, uint *itemClass);
+  void initAvg();
+  void initAvgRandom();
+  void initAvgPlusPlus();
+  void initAvgParallel();
+  void prepareInitScale();
+  double updateItemWeights(const double *centers, uint centerCount, bool resetWeights);
+  uint pickWeightedItem(double target);
+  void selectWeightedCenters(const std::vector<double> &candidates, const std::vector<double> &candidateWeights);
+  void calcClassSpace();
+  void prepareBlocks();
+  void updateItemClass(uint *itemClass);
+  void updateBlock(uint blockIdx, uint *itemClass);
+  uint updateAvg();
+  void prepareBounds();
+  void saveBoundsBase();
+  void buildTree();
+  uint addTreeNode(uint beginPos, uint endPos, const double *low, const double *high);
+  void buildTreeNode(uint nodeIdx, uint depth, double *points);
+  void prepareTreeFrontier();
+  void updateItemClassTree(uint *itemClass);
+  void filterTreeNode(uint blockIdx, uint nodeIdx, uint prevClassIdx, uint candPos, std::vector<uint> &candidates,
+    uint *itemClass, double *element, double *distances, std::vector<uint> &itemClassSet);
+  uint countTreeChanges(uint nodeIdx, uint oldClassIdx, uint classIdx, const uint *itemClass) const;
+  void assignTreeNode(uint nodeIdx, uint *itemClass) const;
+  uint findClassFull(uint itemIdx, const double *element, double *distances, std::vector<uint> &itemClassSet,
+    scKMeansStepStats &stats);
+  uint findClassHamerly(uint itemIdx, uint oldClassIdx, double *element, bool &elementLoaded, double *distances,
+    std::vector<uint> &itemClassSet, scKMeansStepStats &stats);
+  uint findClassElkan(uint itemIdx, uint oldClassIdx, double *element, bool &elementLoaded, double *distances,
+    std::vector<uint> &itemClassSet, scKMeansStepStats &stats);
+  uint selectBestClass(uint itemIdx, const double *element, const double *distances,
+    std::vector<uint> &itemClassSet) const;
+  uint getTieBreakIndex(uint itemIdx, uint tieCount) const;
+  uint getWorkerCount() const;
+  void loadItem(uint itemIdx, double *output) const;
+protected:
+  // config
+  uint m_classCount;
+  uint m_stepLimit;
+  uint m_threadCount;
+  uint64 m_seed;
+  bool m_seedEnabled;
+  scRandomGenerator *m_randomSource;
+  scKMeansSimdLevel m_simdLevel;
+  scKMeansAccelMode m_accelMode;
+  scKMeansInitMode m_initMode;
+  uint m_initRoundCount;
+  double m_initOversampling;
+  const scKMeansFeatureTransform *m_transform;
+  std::vector<double> m_inputScale;
+  std::vector<double> m_inputOffset;
+  bool m_incrementalUpdate;
+  double m_tolerance;
+  // input
+  const T *m_input;
+  const scKMeansItemReader *m_reader;
+  uint m_itemCount;
+  uint m_dimCount;
+  // state
+  uint m_realClassCount;
+  uint m_stepNo;
+  bool m_reproducible;
+  uint64 m_runSeed;
+  uint m_blockSize;
+  uint m_blockCount;
+  scKMeansDistanceKernel m_distanceKernel;
+  uint m_classStride;
+  std::vector<double> m_classAvg;
+  std::vector<double> m_classAvgT;
+  std::vector<double> m_classSpace;
+  std::vector<double> m_classScale;
+  std::vector<double> m_blockSums;
+  std::vector<uint> m_blockCounts;
+  // incremental update: sums and counts of all classes kept between steps
+  bool m_sumsValid;
+  std::vector<double> m_classSums;
+  std::vector<uint> m_classCounts;
+  std::vector<scKMeansStepStats> m_blockStats;
+  scRandomGenerator m_random;
+  // initialization
+  std::vector<double> m_initScale;
+  std::vector<double> m_itemWeights;
+  std::vector<double> m_blockWeights;
+  std::vector<scKMeansStepStats> m_stepStats;
+  // bounds
+  bool m_boundsValid;
+  double m_scaleRatioMin;
+  double m_scaleRatioMax;
+  uint m_maxDriftIdx;
+  double m_maxDrift;
+  double m_maxDrift2;
+  std::vector<double> m_upperBound;
+  std::vector<double> m_lowerBound;
+  // Elkan: lower bounds of item are decayed only when they are read, using
+  // metric change and class moves of each step since history position
+  std::vector<uint> m_lowerBoundStep;
+  std::vector<double> m_scaleRatioHistory;
+  std::vector<double> m_driftHistory;
+  std::vector<double> m_prevClassAvg;
+  std::vector<double> m_prevClassScale;
+  std::vector<double> m_classDrift;
+  std::vector<double> m_classHalfDist;
+  std::vector<double> m_classHalfMin;
+  // k-d tree, nodes in pre-order (left child follows its parent)
+  std::vector<uint> m_treeIndex;
+  std::vector<uint> m_treeBegin;
+  std::vector<uint> m_treeEnd;
+  std::vector<uint> m_treeRight;
+  std::vector<uint> m_treeClass;
+  std::vector<double> m_treeLow;
+  std::vector<double> m_treeHigh;
+  std::vector<double> m_treeSum;
+  std::vector<uint> m_treeFrontier;
+};
+
+// ----------------------------------------------------------------------------
+// Function declarations
+// ----------------------------------------------------------------------------
+/// Calculate space (range of class averages, 1.0 for zero range) and scale
+/// (1 / space) for each dimension, used to normalize distances.
+void calcKMeansClassScale(const double *classAvg, uint classCount, uint dimCount,
+  std::vector<double> &classSpace, std::vector<double> &classScale);
+
+#endif // _KMEANS_DENSE_H__
@@ -0,0 +1,169 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_io.h
+// Project:     scLib
+// Purpose:     File access for clustering input.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _KMEANS_IO_H__
+#define _KMEANS_IO_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file kmeans_io.h
+///
+/// Memory-mapped access to files which can be larger than RAM or address
+/// space - only a window of the file is mapped at once.
+///
+/// Matrix file format (native byte order):
+///   offset  size  contents
+///        0     4  magic "SCKM"
+///        4     4  byte order mark 0x01020304
+///        8     4  format version (1)
+///       12     4  value type (1 = float, 2 = double)
+///       16     4  dim count
+///       20     4  reserved (0)
+///       24     8  item count
+///       32     8  data offset (64)
+///       40    24  reserved (0)
+///       64     -  items, row-major: itemCount rows of dimCount values
+/// Data offset is aligned, so mapped items can be used in place.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <memory>
+#include <fstream>
+
+//base
+#include "base/btypes.h"
+#include "base/string.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+enum scKMeansValueType {
+  kvt_float = 1,
+  kvt_double = 2
+};
+
+/// Decoded header of matrix file
+struct scKMeansMatrixHeader {
+  scKMeansValueType valueType;
+  uint dimCount;
+  uint64 itemCount;
+  uint64 dataOffset;
+};
+
+// ----------------------------------------------------------------------------
+// Forward class definitions
+// ----------------------------------------------------------------------------
+namespace boost { namespace iostreams { class mapped_file_source; } }
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+// default size of file window mapped at once
+const uint64 KMEANS_DEF_MAP_WINDOW_SIZE = 64 * 1024 * 1024;
+const uint KMEANS_MATRIX_VERSION = 1;
+const uint KMEANS_MATRIX_HEADER_SIZE = 64;
+const uint KMEANS_MATRIX_BYTE_ORDER_MARK = 0x01020304;
+// number of values converted at once by writer
+const uint KMEANS_MATRIX_WRITE_BUFFER_SIZE = 4096;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Read-only, memory-mapped view of a file.
+class scMappedFileReader {
+public:
+  // -- create
+  scMappedFileReader();
+  ~scMappedFileReader();
+  // -- properties
+  /// minimal size of mapped window, bigger windows are mapped when requested
+  void setWindowSize(uint64 value);
+  // -- run
+  void open(const dtpString &fileName);
+  void close();
+  bool isOpen() const;
+  uint64 getFileSize() const;
+  /// Returns pointer to size bytes of file starting at offset.
+  /// Pointer is valid until next call of map() or close().
+  const char *map(uint64 offset, uint64 size);
+protected:
+  void mapWindow(uint64 offset, uint64 size);
+protected:
+  dtpString m_fileName;
+  uint64 m_fileSize;
+  uint64 m_windowSize;
+  uint64 m_mappedOffset;
+  uint64 m_mappedSize;
+  std::auto_ptr<boost::iostreams::mapped_file_source> m_file;
+};
+
+/// Writer of matrix file, items can be added in any number of calls.
+/// Item count in header is updated on close.
+class scKMeansMatrixWriter {
+public:
+  // -- create
+  scKMeansMatrixWriter();
+  ~scKMeansMatrixWriter();
+  // -- run
+  void open(const dtpString &fileName, uint dimCount, scKMeansValueType valueType = kvt_double);
+  /// Append itemCount rows of dimCount values, converted to file value type
+  void writeItems(const double *values, uint itemCount);
+  void writeItems(const float *values, uint itemCount);
+  void close();
+  // -- properties
+  uint64 getItemCount() const;
+protected:
+  template < class T >
+  void writeValues(const T *values, size_t valueCount);
+  template < class T, class FileType >
+  void writeConverted(const T *values, size_t valueCount);
+  void writeHeader();
+  void checkState();
+protected:
+  std::ofstream m_file;
+  dtpString m_fileName;
+  scKMeansMatrixHeader m_header;
+};
+
+/// Reader of matrix file. Items are memory-mapped and accessed in place.
+class scKMeansMatrixReader {
+public:
+  // -- create
+  scKMeansMatrixReader();
+  // -- run
+  void open(const dtpString &fileName);
+  void close();
+  // -- properties
+  const scKMeansMatrixHeader &getHeader() const;
+  uint getDimCount() const;
+  uint64 getItemCount() const;
+  scKMeansValueType getValueType() const;
+  /// mapped items, NULL if file stores different type (or no items)
+  const double *getDoubleItems() const;
+  const float *getFloatItems() const;
+protected:
+  scMappedFileReader m_file;
+  scKMeansMatrixHeader m_header;
+  const char *m_data;
+};
+
+// ----------------------------------------------------------------------------
+// Function declarations
+// ----------------------------------------------------------------------------
+/// Read and validate header of matrix file, throws std::runtime_error on error.
+/// Data offset has to be multiple of value size and data size has to fit in uint64.
+void readKMeansMatrixHeader(const dtpString &fileName, scKMeansMatrixHeader &output);
+/// Size of a single value of a given type in bytes
+uint getKMeansValueSize(scKMeansValueType valueType);
+
+#endif // _KMEANS_IO_H__
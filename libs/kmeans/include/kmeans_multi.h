@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_multi.h
+// Project:     scLib
+// Purpose:     k-means with several independent restarts.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _KMEANS_MULTI_H__
+#define _KMEANS_MULTI_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file kmeans_multi.h
+///
+/// Runs scDenseKMeans several times with different seeds and returns
+/// classes of the run with the lowest inertia (within-class sum of squares).
+/// Runs are executed in parallel, all of them read the same input buffer.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+
+//sc
+#include "sc/alg/kmeans_dense.h"
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint KMEANS_DEF_RESTART_COUNT = 10;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Multi-start k-means. Run r uses seed randomHash(seed + r), so result does
+/// not depend on number of threads. On equal inertia lower run number wins.
+template < class T >
+class scMultiStartKMeans {
+public:
+  // -- create
+  scMultiStartKMeans();
+  // -- properties
+  /// configuration used by each run, seed is replaced by run seed
+  scDenseKMeans<T> &getEngine();
+  void setRestartCount(uint value);
+  /// number of runs executed at once, 0 = OpenMP default (default), 1 = one by one.
+  /// When runs are executed in parallel each run uses one thread.
+  void setThreadCount(uint value);
+  /// base seed for runs, random if not set
+  void setSeed(uint64 value);
+  /// generator which gives base seed when seed is not set (not owned)
+  void setRandomGenerator(scRandomGenerator *value);
+  // -- run
+  /// Returns number of classes of best run, classes are stored in itemClass
+  uint execute(const T *input, uint itemCount, uint dimCount, uint *itemClass);
+  uint execute(const scKMeansItemReader &input, uint itemCount, uint dimCount, uint *itemClass);
+  // -- results
+  uint getBestRun() const;
+  double getBestInertia() const;
+  const std::vector<double> &getRunInertia() const;
+  const std::vector<uint> &getRunStepCount() const;
+  /// class averages of best run
+  const std::vector<double> &getClassAvg() const;
+protected:
+  uint run(uint itemCount, uint dimCount, uint *itemClass);
+  uint getWorkerCount() const;
+protected:
+  // config
+  scDenseKMeans<T> m_engine;
+  uint m_restartCount;
+  uint m_threadCount;
+  uint64 m_seed;
+  bool m_seedEnabled;
+  scRandomGenerator *m_randomSource;
+  // input
+  const T *m_input;
+  const scKMeansItemReader *m_reader;
+  // results
+  uint m_bestRun;
+  uint m_realClassCount;
+  std::vector<double> m_runInertia;
+  std::vector<uint> m_runStepCount;
+  std::vector<double> m_classAvg;
+};
+
+#endif // _KMEANS_MULTI_H__
@@ -0,0 +1,110 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_quant.h
+// Project:     scLib
+// Purpose:     Quantized (8-bit) storage of k-means input.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _KMEANS_QUANT_H__
+#define _KMEANS_QUANT_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file kmeans_quant.h
+///
+/// Input matrix stored as signed char codes with per-dimension scale and
+/// offset (value = code * scale + offset), 8 times less memory than double.
+/// Codes are used directly by scDenseKMeans<signed char>:
+///
+///   engine.setInputScale(matrix.getScale(), matrix.getOffset());
+///   engine.execute(matrix.getData(), matrix.getItemCount(), matrix.getDimCount(), itemClass);
+///
+/// compareKMeansStorage() measures throughput of double, float and quantized
+/// storage and agreement of their classes with double storage.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+
+//sc
+#include "sc/alg/kmeans_dense.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+enum scKMeansStorageType {
+  kst_double,
+  kst_float,
+  kst_quantized
+};
+
+/// Result of storage comparison, one for each scKMeansStorageType
+struct scKMeansStorageStats {
+  uint valueSize;          ///< bytes per coordinate
+  uint stepCount;          ///< steps performed by engine
+  double runTime;          ///< seconds spent in execute()
+  double itemRate;         ///< items processed per second (item count x steps / time)
+  double assignAgreement;  ///< fraction of items with the same class as double input for the same class averages
+  double runAgreement;     ///< fraction of items with the same class as double input after whole run
+};
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+// codes are symmetric: -KMEANS_QUANT_MAX_CODE..KMEANS_QUANT_MAX_CODE
+const int KMEANS_QUANT_MAX_CODE = 127;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Row-major matrix of signed char codes. Range of each dimension is mapped
+/// linearly to codes, so error of value is at most scale / 2.
+/// Values which are not finite are stored as offset.
+class scKMeansQuantizedMatrix {
+public:
+  // -- create
+  scKMeansQuantizedMatrix();
+  // -- run
+  void quantize(const double *input, uint itemCount, uint dimCount);
+  void quantize(const float *input, uint itemCount, uint dimCount);
+  void clear();
+  /// decoded values of item
+  void readItem(uint itemIdx, double *output) const;
+  // -- properties
+  const signed char *getData() const;
+  uint getItemCount() const;
+  uint getDimCount() const;
+  const std::vector<double> &getScale() const;
+  const std::vector<double> &getOffset() const;
+protected:
+  template < class T >
+  void quantizeValues(const T *input, uint itemCount, uint dimCount);
+protected:
+  uint m_itemCount;
+  uint m_dimCount;
+  std::vector<signed char> m_data;
+  std::vector<double> m_scale;
+  std::vector<double> m_offset;
+};
+
+// ----------------------------------------------------------------------------
+// Function declarations
+// ----------------------------------------------------------------------------
+/// Run k-means on input stored as double, float and quantized values with the
+/// same seed and compare them. Assignment agreement uses class averages found
+/// for double input, so it shows effect of storage only. stats receives one
+/// entry for each scKMeansStorageType. Float and quantized copies are created
+/// by this function.
+void compareKMeansStorage(const double *input, uint itemCount, uint dimCount, uint classCount, uint stepLimit,
+  uint threadCount, uint64 seed, std::vector<scKMeansStorageStats> &stats);
+
+#endif // _KMEANS_QUANT_H__
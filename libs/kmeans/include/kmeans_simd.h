@@ -0,0 +1,77 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_simd.h
+// Project:     scLib
+// Purpose:     Vectorized distance kernels for k-means.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _KMEANS_SIMD_H__
+#define _KMEANS_SIMD_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file kmeans_simd.h
+///
+/// Distance from one item to all class averages in one pass.
+/// Distance is sum of ((item[k] - avg[k]) * classScale[k])^2, where
+/// classScale[k] = 1 / classSpace[k]. Result is not square-rooted, which does
+/// not change order of distances.
+/// Vector kernels use one lane per class and add dimensions in the same
+/// order as the scalar version, so all kernels return identical values.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+enum scKMeansSimdLevel {
+  ksl_auto,
+  ksl_scalar,
+  ksl_sse2,
+  ksl_avx2,
+  ksl_avx512
+};
+
+/// Calculate distance from item to each class.
+/// classAvgT - transposed class averages: dimCount rows of classStride values
+/// output - classStride values
+typedef void (*scKMeansDistanceKernel)(const double *item, const double *classAvgT, const double *classScale,
+  uint dimCount, uint classStride, double *output);
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+/// class count in transposed averages is rounded up to multiple of this value
+const uint KMEANS_SIMD_CLASS_ALIGN = 8;
+
+// ----------------------------------------------------------------------------
+// Function declarations
+// ----------------------------------------------------------------------------
+/// Returns best level supported by CPU and OS
+scKMeansSimdLevel detectKMeansSimdLevel();
+/// Returns kernel for a given level, ksl_auto or unsupported level selects best available one
+scKMeansDistanceKernel getKMeansDistanceKernel(scKMeansSimdLevel level);
+/// Returns level really used for a given requested one
+scKMeansSimdLevel resolveKMeansSimdLevel(scKMeansSimdLevel level);
+/// Distance from item to single class average (row), same value as returned by kernels
+double calcKMeansDistance(const double *item, const double *classAvg, const double *classScale, uint dimCount);
+/// Distance calculated as in original scKMeansCalculator: sum of ((item[k] - avg[k]) / classSpace[k])^2.
+/// Differs from kernels by rounding only, used to decide between nearly equal distances.
+double calcKMeansExactDistance(const double *item, const double *classAvg, const double *classSpace, uint dimCount);
+/// Number of columns in transposed averages
+uint calcKMeansClassStride(uint classCount);
+/// Convert row-major class averages to layout used by kernels
+void transposeKMeansClassAvg(const double *classAvg, uint classCount, uint dimCount, std::vector<double> &output);
+
+#endif // _KMEANS_SIMD_H__
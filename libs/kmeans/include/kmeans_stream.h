@@ -0,0 +1,217 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_stream.h
+// Project:     scLib
+// Purpose:     Mini-batch k-means for input read in chunks.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _KMEANS_STREAM_H__
+#define _KMEANS_STREAM_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file kmeans_stream.h
+///
+/// Clustering of data sets which do not fit into memory.
+/// Input is read from a chunk source in batches of fixed size, class averages
+/// are updated after each batch with per-class learning rate 1 / (number of
+/// items assigned to class so far). Classes are then assigned in a second
+/// pass and passed to a sink chunk by chunk.
+/// Memory used does not depend on number of items (batch size x dim count).
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+#include <memory>
+
+//base
+#include "base/btypes.h"
+#include "base/string.h"
+
+//sc
+#include "sc/alg/kmeans_dense.h"
+#include "sc/alg/kmeans_io.h"
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint KMEANS_DEF_BATCH_SIZE = 4096;
+const uint KMEANS_DEF_EPOCH_COUNT = 1;
+// number of batch items assigned by one worker at once
+const uint KMEANS_STREAM_BLOCK_SIZE = 256;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Source of items, read sequentially in chunks
+class scKMeansChunkSource {
+public:
+  virtual ~scKMeansChunkSource() {}
+  virtual uint getDimCount() const = 0;
+  /// Copy up to maxItemCount next items to output (row-major).
+  /// Returns number of items copied, 0 at end of data.
+  virtual uint readChunk(double *output, uint maxItemCount) = 0;
+  /// Restart reading from first item
+  virtual void rewind() = 0;
+};
+
+/// Items read from a range of values convertible to double, dimCount values per item
+template < class InputIterator >
+class scKMeansIteratorSource: public scKMeansChunkSource {
+public:
+  scKMeansIteratorSource(InputIterator beginPos, InputIterator endPos, uint dimCount):
+    m_beginPos(beginPos), m_endPos(endPos), m_currPos(beginPos), m_dimCount(dimCount) {}
+  virtual uint getDimCount() const { return m_dimCount; }
+  virtual uint readChunk(double *output, uint maxItemCount) {
+    uint res = 0;
+    uint k;
+    while ((res < maxItemCount) && (m_currPos != m_endPos)) {
+      for(k=0; (k != m_dimCount) && (m_currPos != m_endPos); k++, ++m_currPos)
+        *output++ = static_cast<double>(*m_currPos);
+      // incomplete item at the end is skipped
+      if (k == m_dimCount)
+        res++;
+    }
+    return res;
+  }
+  virtual void rewind() { m_currPos = m_beginPos; }
+protected:
+  InputIterator m_beginPos;
+  InputIterator m_endPos;
+  InputIterator m_currPos;
+  uint m_dimCount;
+};
+
+/// Items read from raw file of T values (float or double, native byte order),
+/// dimCount values per item, starting at dataOffset.
+/// File is memory-mapped in windows, so it can be bigger than address space.
+template < class T >
+class scKMeansMappedFileSource: public scKMeansChunkSource {
+public:
+  // -- create
+  scKMeansMappedFileSource(const dtpString &fileName, uint dimCount, uint64 dataOffset = 0);
+  // -- properties
+  void setWindowSize(uint64 value);
+  uint64 getItemCount() const;
+  // -- run
+  virtual uint getDimCount() const;
+  virtual uint readChunk(double *output, uint maxItemCount);
+  virtual void rewind();
+protected:
+  scMappedFileReader m_reader;
+  uint m_dimCount;
+  uint64 m_dataOffset;
+  uint64 m_itemCount;
+  uint64 m_itemNo;
+};
+
+/// Items read from matrix file (see kmeans_io.h), stored as float or double
+class scKMeansMatrixFileSource: public scKMeansChunkSource {
+public:
+  // -- create
+  scKMeansMatrixFileSource(const dtpString &fileName);
+  // -- properties
+  const scKMeansMatrixHeader &getHeader() const;
+  // -- run
+  virtual uint getDimCount() const;
+  virtual uint readChunk(double *output, uint maxItemCount);
+  virtual void rewind();
+protected:
+  scKMeansMatrixHeader m_header;
+  std::auto_ptr<scKMeansChunkSource> m_source;
+  uint64 m_itemNo;
+};
+
+/// Receiver of item classes, called with consecutive chunks
+class scKMeansClassSink {
+public:
+  virtual ~scKMeansClassSink() {}
+  virtual void putClasses(const uint *itemClass, uint itemCount) = 0;
+};
+
+/// Sink appending classes to a vector
+class scKMeansVectorSink: public scKMeansClassSink {
+public:
+  scKMeansVectorSink(std::vector<uint> &output): m_output(output) {}
+  virtual void putClasses(const uint *itemClass, uint itemCount) {
+    m_output.insert(m_output.end(), itemClass, itemClass + itemCount);
+  }
+protected:
+  std::vector<uint> &m_output;
+};
+
+/// Mini-batch k-means (Sculley) for chunked input.
+/// Class averages are initialized by scDenseKMeans run on the first batch.
+/// Result depends only on input, batch size and seed - not on thread count.
+class scStreamKMeans {
+public:
+  // -- create
+  scStreamKMeans();
+  // -- properties
+  /// number of classes, limited by size of first batch
+  void setClassCount(uint value);
+  /// number of items in one batch, also size of chunk read from source
+  void setBatchSize(uint value);
+  /// number of training passes over input
+  void setEpochCount(uint value);
+  /// number of worker threads, 0 = OpenMP default, 1 = no threading (default)
+  void setThreadCount(uint value);
+  void setSeed(uint64 value);
+  void setSimdLevel(scKMeansSimdLevel value);
+  /// initialization used on first batch
+  void setInitMode(scKMeansInitMode value);
+  /// transform applied to each item when it is read, NULL = none (default), not owned
+  void setTransform(const scKMeansFeatureTransform *value);
+  // -- run
+  /// Learn class averages from source, returns number of classes (0 for empty input)
+  uint train(scKMeansChunkSource &source);
+  /// Assign nearest class to each item of source using learned averages
+  void assign(scKMeansChunkSource &source, scKMeansClassSink &output);
+  /// train + assign
+  uint execute(scKMeansChunkSource &source, scKMeansClassSink &output);
+  // -- results
+  /// class averages, classCount rows of dimCount values
+  const std::vector<double> &getClassAvg() const;
+  /// number of items used for update of each class
+  const std::vector<uint64> &getClassItemCount() const;
+  uint64 getBatchCount() const;
+protected:
+  uint readBatch(scKMeansChunkSource &source);
+  void initAvg(uint itemCount);
+  void prepareDistance();
+  void assignBatch(uint itemCount, uint64 batchNo);
+  void updateAvg(uint itemCount);
+  uint findClass(uint itemIdx, uint64 batchKey, double *distances) const;
+  uint getWorkerCount() const;
+protected:
+  // config
+  uint m_classCount;
+  uint m_batchSize;
+  uint m_epochCount;
+  uint m_threadCount;
+  uint64 m_seed;
+  scKMeansSimdLevel m_simdLevel;
+  scKMeansInitMode m_initMode;
+  const scKMeansFeatureTransform *m_transform;
+  // state
+  uint m_dimCount;
+  uint m_realClassCount;
+  uint64 m_batchCount;
+  scKMeansDistanceKernel m_distanceKernel;
+  uint m_classStride;
+  std::vector<double> m_batch;
+  std::vector<uint> m_batchClass;
+  std::vector<double> m_classAvg;
+  std::vector<double> m_classAvgT;
+  std::vector<double> m_classSpace;
+  std::vector<double> m_classScale;
+  std::vector<uint64> m_classItemCount;
+};
+
+#endif // _KMEANS_STREAM_H__
@@ -0,0 +1,81 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_transform.h
+// Project:     scLib
+// Purpose:     Feature transforms applied to k-means input when it is read.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _KMEANS_TRANSFORM_H__
+#define _KMEANS_TRANSFORM_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file kmeans_transform.h
+///
+/// Transform of item coordinates performed each time an item is loaded by
+/// k-means engine, so transformed copy of input is never stored.
+/// Class averages are calculated in transformed space.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Base class for transforms. Must be safe to call from several threads.
+class scKMeansFeatureTransform {
+public:
+  virtual ~scKMeansFeatureTransform() {}
+  /// Transform dimCount values of one item in place
+  virtual void apply(double *values, uint dimCount) const = 0;
+};
+
+/// No change of values
+class scKMeansIdentityTransform: public scKMeansFeatureTransform {
+public:
+  virtual void apply(double *values, uint dimCount) const;
+};
+
+/// sign(x) * log10(|x|), used by scKMeansCalculator as input filter
+class scKMeansLog10Transform: public scKMeansFeatureTransform {
+public:
+  virtual void apply(double *values, uint dimCount) const;
+};
+
+/// (x - mean) / stdDev in each dimension.
+/// Statistics are given directly or collected item by item (Welford).
+class scKMeansZScoreTransform: public scKMeansFeatureTransform {
+public:
+  // -- create
+  scKMeansZScoreTransform();
+  // -- properties
+  /// zero deviation is replaced by 1.0
+  void setStats(const std::vector<double> &mean, const std::vector<double> &stdDev);
+  const std::vector<double> &getMean() const;
+  const std::vector<double> &getStdDev() const;
+  // -- run
+  void resetStats(uint dimCount);
+  void addItem(const double *values);
+  void finishStats();
+  virtual void apply(double *values, uint dimCount) const;
+protected:
+  void prepareScale();
+protected:
+  uint64 m_itemCount;
+  std::vector<double> m_mean;
+  std::vector<double> m_sumSq;
+  std::vector<double> m_stdDev;
+  std::vector<double> m_scale;
+};
+
+#endif // _KMEANS_TRANSFORM_H__
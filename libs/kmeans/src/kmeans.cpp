@@ -7,11 +7,10 @@
 // Created:     20/12/2009
 /////////////////////////////////////////////////////////////////////////////
 
-#include <set>
+#include <vector>
 #include <cmath>
-
-//base
-#include "base/rand.h"
+#include <climits>
+#include <stdexcept>
 
 //perf
 #include "perf/Log.h"
@@ -21,6 +20,10 @@
 #include "sc/utils.h"
 #include "sc/dtypes.h"
 #include "sc/alg/kmeans.h"
+#include "sc/alg/kmeans_dense.h"
+#include "sc/alg/kmeans_io.h"
+#include "sc/alg/kmeans_multi.h"
+#include "sc/alg/kmeans_1d.h"
 #include "sc/smath.h"
 
 #ifdef DEBUG_MEM
@@ -33,371 +36,225 @@
 using namespace dtp;
 using namespace perf;
 
-template < class T >
-T fpSafeLog10(T arg)
+// ----------------------------------------------------------------------------
+// scKMeansDataNodeReader
+// ----------------------------------------------------------------------------
+// items are scalars (dim count = 1) or lists of values
+class scKMeansDataNodeReader: public scKMeansItemReader {
+public:
+  scKMeansDataNodeReader(const scDataNode &input, uint dimCount): m_input(input), m_dimCount(dimCount) {}
+  virtual void readItem(uint itemIdx, double *output) const {
+    if (m_dimCount == 1) {
+      *output = m_input.getDouble(itemIdx);
+    } else {
+      const scDataNode *elementPtr = &m_input[itemIdx];
+      for(uint j = 0; j != m_dimCount; j++)
+        output[j] = elementPtr->getDouble(j);
+    }
+  }
+protected:
+  const scDataNode &m_input;
+  uint m_dimCount;
+};
+
+// ----------------------------------------------------------------------------
+// scKMeansCalculator
+// ----------------------------------------------------------------------------
+scKMeansCalculator::scKMeansCalculator()
 {
-  return (fpSign<T>(arg) * log10(fpAbs<T>(arg)));
+  m_randomSource = NULL;
 }
 
-void scKMeansCalculator::execute(const scDataNode &inputVector, scDataNode &output, uint classCount, uint stepLimit)
+void scKMeansCalculator::setRandomGenerator(scRandomGenerator *value)
 {
-  scDataNode itemClassList;
-  scDataNode classAvg;
-  uint realClassCount;
-  uint changedAvgCount;
-  uint step;
-  scDataNode newInputVector;
-  const scDataNode *useInputVector;
+  m_randomSource = value;
+}
 
+// input is read directly from scDataNode, filter is applied to each item when it is loaded
+void scKMeansCalculator::execute(const scDataNode &inputVector, scDataNode &output, uint classCount, uint stepLimit)
+{
+  std::vector<uint> itemClass;
+  scDenseKMeans<double> engine;
+  const uint dimCount = getInputDimCount(inputVector);
+  scKMeansDataNodeReader reader(inputVector, dimCount);
 #ifdef USE_LOG10_FILTER
-  prepareInputVector(inputVector, newInputVector);
-  useInputVector = &newInputVector;
+  scKMeansLog10Transform filter;
 #else
-  useInputVector = &inputVector;
+  scKMeansIdentityTransform filter;
 #endif
-      
+
   output.clear();
-    
-  if (!classCount) 
-    realClassCount = (*useInputVector).size();
-  else  
-    realClassCount = std::min<uint>(classCount, (*useInputVector).size());
 
-  if (!realClassCount)
+  itemClass.resize(inputVector.size());
+
+  if (itemClass.empty())
     return;
-    
-  output.setAsArray(vt_uint);      
-  for(uint i=0, epos = (*useInputVector).size(); i != epos; i++)
-    output.addItemAsUInt(0);
-  
+
 #ifdef DEBUG_KMEANS
   Log::addDebug("kmeans-1");  
 #endif  
-  initAvg((*useInputVector), realClassCount, classAvg);
-  step = 0;
-  do {
-    updateItemClass((*useInputVector), classAvg, output);
-    changedAvgCount = updateAvg((*useInputVector), output, classAvg);
-    step++;
-  } while((changedAvgCount > 0) && (step < stepLimit));  
+  // 1-D input: exact solution, iterative one only for non-finite values
+  bool solved = false;
+  if (dimCount == 1) {
+    scKMeans1D<double> exactEngine;
+    exactEngine.setClassCount(classCount);
+    exactEngine.setTransform(&filter);
+    solved = (exactEngine.execute(reader, itemClass.size(), &itemClass[0]) > 0);
+  }
+
+  if (!solved) {
+    engine.setClassCount(classCount);
+    engine.setStepLimit(stepLimit);
+    engine.setTransform(&filter);
+    engine.setRandomGenerator(m_randomSource);
+    engine.execute(reader, itemClass.size(), dimCount, &itemClass[0]);
+  }
 #ifdef DEBUG_KMEANS
   Log::addDebug("kmeans-2");  
 #endif  
-}
 
-void scKMeansCalculator::prepareInputVector(const scDataNode &inputVector, scDataNode &output)
-{
-  bool oneDim = true;
-  if (inputVector.size() > 0)
-    oneDim = (inputVector.getElement(0).size() < 2);
-  uint dimSize = 0;
-  if (!oneDim)
-    dimSize = inputVector.getElement(0).size();
-  uint j;   
-  scDataNode element; 
-    
-  if (oneDim)
-    output.setAsArray(vt_double);
-  else  
-    output.setAsArray(vt_datanode);
-      
-  for(uint i=0, epos = inputVector.size(); i != epos; i++)
-  {
-    if (oneDim) {
-      output.addItemAsDouble(fpSafeLog10(inputVector.getDouble(i)));
-    } else {
-      inputVector.getElement(i, element);
-      for(j = 0; j != dimSize; j++)
-        element.setDouble(j, fpSafeLog10(element.getDouble(j)));
-      output.addItem(element);  
-    }  
-  }  
+  prepareOutput(itemClass, output);
 }
 
-void scKMeansCalculator::initAvg(const scDataNode &inputVector, uint classCount, scDataNode &classAvg)
+// all runs read the same scDataNode input
+void scKMeansCalculator::executeRestarts(const scDataNode &inputVector, scDataNode &output, uint restartCount, 
+  uint classCount, uint stepLimit, std::vector<double> *runInertia)
 {
-  std::set<uint> centroids;
-  uint randomPoint, inputSize;
-  inputSize = inputVector.size();
-  std::auto_ptr<scDataNode> dataNodeGuard;
-  const scDataNode *dataNodePtr;
+  std::vector<uint> itemClass;
+  scMultiStartKMeans<double> engine;
+  const uint dimCount = getInputDimCount(inputVector);
+  scKMeansDataNodeReader reader(inputVector, dimCount);
+#ifdef USE_LOG10_FILTER
+  scKMeansLog10Transform filter;
+#else
+  scKMeansIdentityTransform filter;
+#endif
 
-  do {
-    randomPoint = randomUInt(0, inputVector.size() - 1);
-    centroids.insert(randomPoint);
-  } while ((centroids.size() < classCount) && (centroids.size() < inputSize));
+  output.clear();
+  if (runInertia)
+    runInertia->clear();
 
-  bool oneDim = true;
-  if (inputSize > 0)
-    oneDim = (inputVector.getElement(0).size() < 2);
-    
-  for(std::set<uint>::const_iterator it = centroids.begin(), epos = centroids.end(); it != epos; ++it)
-  {
-    if (oneDim)
-      classAvg.addChild(new scDataNode(inputVector.getDouble(*it)));    
-    else {  
-      dataNodeGuard.reset(new scDataNode());
-      dataNodePtr = &inputVector[*it];
-      for(uint i=0, epos = inputVector[*it].size(); i != epos; i++)
-        dataNodeGuard->addChild(new scDataNode(dataNodePtr->getDouble(i)));    
-      classAvg.addChild(dataNodeGuard.release());
-    }  
-  }  
+  itemClass.resize(inputVector.size());
+
+  if (itemClass.empty())
+    return;
+
+  // 1-D input: exact solution as in execute(), restarts are not needed
+  if (dimCount == 1) {
+    scKMeans1D<double> exactEngine;
+    exactEngine.setClassCount(classCount);
+    exactEngine.setTransform(&filter);
+    if (exactEngine.execute(reader, itemClass.size(), &itemClass[0]) > 0) {
+      if (runInertia)
+        runInertia->assign(1, exactEngine.getInertia());
+      prepareOutput(itemClass, output);
+      return;
+    }
+  }
+
+  engine.setRestartCount(restartCount);
+  engine.getEngine().setClassCount(classCount);
+  engine.getEngine().setStepLimit(stepLimit);
+  engine.getEngine().setTransform(&filter);
+  engine.setRandomGenerator(m_randomSource);
+
+  engine.execute(reader, itemClass.size(), dimCount, &itemClass[0]);
+
+  if (runInertia)
+    *runInertia = engine.getRunInertia();
+
+  prepareOutput(itemClass, output);
 }
 
-void scKMeansCalculator::updateItemClass(const scDataNode &inputVector, const scDataNode &classAvg, scDataNode &itemClassList)
+void scKMeansCalculator::executeFile(const scString &fileName, scDataNode &output, uint classCount, uint stepLimit)
 {
-  scDataNode element;
+  scKMeansMatrixReader reader;
+  std::vector<uint> itemClass;
 
-  uint bestClassIdx;
-  double bestClassDist;
-  double distance;
-  uint classCnt = classAvg.size();
-  scDataNode classMin;
-  scDataNode classMax;
-  scDataNode classSpace;
+  output.clear();
+
+  reader.open(fileName);
+  if (reader.getItemCount() > UINT_MAX)
+    throw std::runtime_error("Too many items in matrix file: " + fileName);
+
+  itemClass.resize(static_cast<size_t>(reader.getItemCount()));
 
-  if (!inputVector.size())
+  if (itemClass.empty())
     return;
 
-  uint dimCount = inputVector.getElement(0).size();
-  double value;
-    
-  if (dimCount > 0)   
-  {
-    // find dim min and max
-    for(uint j=0, eposj = classCnt; j != eposj; j++)
-    {
-      for(uint k=0, eposk = classAvg[j].size(); k != eposk; k++)
-      {
-        value = classAvg[j].getDouble(k);
-        if (j == 0)
-        {
-          classMin.addItemAsDouble(value);
-          classMax.addItemAsDouble(value);
-        } else {
-          if (value < classMin.getDouble(k))
-            classMin.setDouble(k, value);
-          if (value > classMax.getDouble(k))
-            classMax.setDouble(k, value);            
-        }  
-      } // for k  
-    } // for j
-
-    // find dim space    
-    for(uint k=0, eposk = dimCount; k != eposk; k++)
+#ifdef DEBUG_KMEANS
+  Log::addDebug("kmeans-1");  
+#endif  
+  // 1-D input: exact solution as in execute()
+  if (reader.getValueType() == kvt_float) {
+    scKMeans1D<float> exactEngine;
+    scDenseKMeans<float> engine;
+    exactEngine.setClassCount(classCount);
+    if ((reader.getDimCount() != 1) ||
+        !exactEngine.execute(reader.getFloatItems(), itemClass.size(), &itemClass[0]))
     {
-      if (
-          classMin.getDouble(k) ==
-          classMax.getDouble(k)
-         )
-      {    
-        classSpace.addItemAsDouble(1.0);
-      } else {  
-        classSpace.addItemAsDouble(
-          fpAbs(
-            classMin.getDouble(k) - 
-            classMax.getDouble(k)
-          )
-        );
-      }
-    } 
-    
-  } else { // dim = 1
-    // find min and max
-    for(uint k=0, eposk = classAvg.size(); k != eposk; k++)
+      engine.setClassCount(classCount);
+      engine.setStepLimit(stepLimit);
+      engine.setRandomGenerator(m_randomSource);
+      engine.execute(reader.getFloatItems(), itemClass.size(), reader.getDimCount(), &itemClass[0]);
+    }
+  } else {
+    scKMeans1D<double> exactEngine;
+    scDenseKMeans<double> engine;
+    exactEngine.setClassCount(classCount);
+    if ((reader.getDimCount() != 1) ||
+        !exactEngine.execute(reader.getDoubleItems(), itemClass.size(), &itemClass[0]))
     {
-      value = classAvg.getDouble(k);
-      if (k == 0) {
-        classMin.setAsDouble(value);
-        classMax.setAsDouble(value);
-      } else {
-        if (value < classMin.getAsDouble())
-          classMin.setAsDouble(value);
-        if (value > classMax.getAsDouble())
-          classMax.setAsDouble(value);    
-      }  
-    }    
-    // find dim space
-    if (
-          classMin.getAsDouble() ==
-          classMax.getAsDouble()
-       )
-    {   
-      classSpace.setAsDouble(1.0);
-    } else {      
-      double a = classMin.getAsDouble();
-      double b = classMax.getAsDouble();
-      classSpace.setAsDouble(
-          fpAbs(a - b)
-      );    
+      engine.setClassCount(classCount);
+      engine.setStepLimit(stepLimit);
+      engine.setRandomGenerator(m_randomSource);
+      engine.execute(reader.getDoubleItems(), itemClass.size(), reader.getDimCount(), &itemClass[0]);
     }
   }
-    
-  std::set<uint> itemClassSet;  
-  std::set<uint>::const_iterator class_it;
-  double a, b;
-  
-  // assign items to classes  
-  for(uint i=0, epos = inputVector.size(); i != epos; i++)
-  {
-    inputVector.getElement(i, element);
-    bestClassIdx = classCnt;
-    bestClassDist = 0.0;
+#ifdef DEBUG_KMEANS
+  Log::addDebug("kmeans-2");  
+#endif  
 
-    for(uint j=0, eposj = classCnt; j != eposj; j++)
-    {
-      distance = 0.0;
-      if (element.size())
-      {
-        for(uint k=0, eposk = element.size(); k != eposk; k++)
-        {
-          distance += 
-            fsqr(
-              fpAbs(element.getDouble(k) - classAvg[j].getDouble(k))
-              /
-              classSpace.getDouble(k)
-            );  
-        }        
-      } else {
-        a = element.getAsDouble();
-        b = classAvg[j].getAsDouble();      
-
-        distance += 
-         fsqr(
-          fpAbs(a - b)
-           /
-          classSpace.getAsDouble()
-          );
-      }      
-      distance = sqrt(distance);
-      if ((bestClassIdx == classCnt) || (distance < bestClassDist))
-      {
-        bestClassIdx = j;
-        bestClassDist = distance;
-        itemClassSet.clear();
-      } else if (distance == bestClassDist) 
-      {
-        if (itemClassSet.empty())
-        {
-          itemClassSet.insert(bestClassIdx);
-        }  
-        itemClassSet.insert(j);          
-      } 
-    } // for j
-    
-    if (!itemClassSet.empty())
-    {
-      bestClassIdx = randomUInt(0, itemClassSet.size() - 1);
-      class_it = itemClassSet.begin();
-      while(bestClassIdx > 0)
-      {
-        class_it++;
-        bestClassIdx--;
-      }
-      bestClassIdx = *class_it;       
-    }
-    
-    itemClassList.setUInt(i, bestClassIdx);
-  } // for i
+  prepareOutput(itemClass, output);
 }
 
-uint scKMeansCalculator::updateAvg(const scDataNode &inputVector, const scDataNode &itemClassList, scDataNode &classAvg)
+// items are converted and written one by one, no copy of whole input is made
+void scKMeansCalculator::exportInput(const scDataNode &inputVector, const scString &fileName, bool useFloat)
 {
-  uint res = 0;
-  scDataNode sums;
-  scDataNode counts;
-  
-  if (!inputVector.size())
-    return res;
-    
-  uint dimCount = inputVector.getElement(0).size();
-  uint classIdx;
-  double oldValue, newValue;
-  bool classChanged;
-
-  if (!dimCount) {
-    // init values
-    counts.setAsArray(vt_int);
-    for(uint i=0, epos = classAvg.size(); i != epos; i++)
-    {
-      sums.addItemAsDouble(0.0);
-      counts.addItemAsInt(0);
-    }  
+  scKMeansMatrixWriter writer;
+  const uint dimCount = getInputDimCount(inputVector);
+  scKMeansDataNodeReader reader(inputVector, dimCount);
+  std::vector<double> element(dimCount);
+#ifdef USE_LOG10_FILTER
+  scKMeansLog10Transform filter;
+#else
+  scKMeansIdentityTransform filter;
+#endif
 
-    // count + sum
-    for(uint i=0, epos = inputVector.size(); i != epos; i++)
-    {
-      classIdx = itemClassList.getUInt(i);
-      sums.setDouble(classIdx, sums.getDouble(classIdx) + inputVector.getDouble(i));
-      counts.setInt(classIdx, counts.getUInt(classIdx) + 1);
-    }      
+  writer.open(fileName, dimCount, useFloat ? kvt_float : kvt_double);
+  for(uint i=0, epos = inputVector.size(); i != epos; i++)
+  {
+    reader.readItem(i, &element[0]);
+    filter.apply(&element[0], dimCount);
+    writer.writeItems(&element[0], 1);
+  }
+  writer.close();
+}
 
-    // calc avg
-    for(uint i=0, epos = classAvg.size(); i != epos; i++)
-    {
-      if (counts.getUInt(i) > 0)
-      {
-        newValue = sums.getDouble(i) / static_cast<double>(counts.getUInt(i));
-      } else {
-        newValue = 0.0;
-      }
-      oldValue = classAvg.getDouble(i);
-      if (oldValue != newValue)
-        res++;
-      classAvg.setDouble(i, newValue);
-    } // for i   
-  } else {
-    // init values
-    for(uint i=0, epos = classAvg.size(); i != epos; i++)
-    {
-      sums.addChild(new scDataNode());
-      counts.addChild(new scDataNode());
-      counts[i].setAsArray(vt_int);
-      for(uint j=0; j != dimCount; j++)
-      {
-        sums[i].addItemAsDouble(0.0);
-        counts[i].addItemAsInt(0);
-      }  
-    }    
-    
-    // count + sum
-    for(uint i=0, epos = inputVector.size(); i != epos; i++)
-    {
-      classIdx = itemClassList.getUInt(i);
-      for(uint j=0; j != dimCount; j++)
-      {
-        sums[classIdx].setDouble(j, sums[classIdx].getDouble(j) + inputVector[i].getDouble(j));
-        counts[classIdx].setInt(j, counts[classIdx].getUInt(j) + 1);
-      }  
-    }      
-    
-    // calc avg
-    for(uint i=0, epos = classAvg.size(); i != epos; i++)
-    {
-      classChanged = false;
-      
-      for(uint j=0; j != dimCount; j++)
-      {
-        if (counts[i].getUInt(j) > 0)
-        {
-          newValue = sums[i].getDouble(j) / static_cast<double>(counts[i].getUInt(j));
-        } else {
-          newValue = 0.0;
-        }
-        oldValue = classAvg[i].getDouble(j);
-        if (oldValue != newValue)
-        {
-          classAvg[i].setDouble(j, newValue);
-          classChanged = true;
-        }
-      } // for j
-
-      if (classChanged)
-        res++;
-    } // for i       
-  } // if dim > 1   
-    
-  return res;
+void scKMeansCalculator::prepareOutput(const std::vector<uint> &itemClass, scDataNode &output)
+{
+  output.setAsArray(vt_uint);      
+  for(uint i=0, epos = itemClass.size(); i != epos; i++)
+    output.addItemAsUInt(itemClass[i]);
 }
 
+uint scKMeansCalculator::getInputDimCount(const scDataNode &inputVector)
+{
+  bool oneDim = true;
+  if (inputVector.size() > 0)
+    oneDim = (inputVector.getElement(0).size() < 2);
+  if (oneDim)
+    return 1;
+  else
+    return inputVector.getElement(0).size();
+}
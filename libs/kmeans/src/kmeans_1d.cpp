@@ -0,0 +1,332 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_1d.cpp
+// Project:     scLib
+// Purpose:     Exact k-means for one-dimensional input.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+//sc
+#include "sc/alg/kmeans_1d.h"
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scKMeans1D
+// ----------------------------------------------------------------------------
+template < class T >
+scKMeans1D<T>::scKMeans1D()
+{
+  m_classCount = KMEANS_DEF_CLASS_COUNT;
+  m_transform = NULL;
+  m_input = NULL;
+  m_reader = NULL;
+  m_itemCount = 0;
+  m_realClassCount = 0;
+  m_shift = 0.0;
+  m_inertia = 0.0;
+}
+
+template < class T >
+void scKMeans1D<T>::setClassCount(uint value)
+{
+  m_classCount = value;
+}
+
+template < class T >
+void scKMeans1D<T>::setTransform(const scKMeansFeatureTransform *value)
+{
+  m_transform = value;
+}
+
+template < class T >
+const std::vector<double> &scKMeans1D<T>::getClassAvg() const
+{
+  return m_classAvg;
+}
+
+template < class T >
+double scKMeans1D<T>::getInertia() const
+{
+  return m_inertia;
+}
+
+template < class T >
+uint scKMeans1D<T>::execute(const T *input, uint itemCount, uint *itemClass)
+{
+  m_input = input;
+  m_reader = NULL;
+  return run(itemCount, itemClass);
+}
+
+template < class T >
+uint scKMeans1D<T>::execute(const scKMeansItemReader &input, uint itemCount, uint *itemClass)
+{
+  m_input = NULL;
+  m_reader = &input;
+  return run(itemCount, itemClass);
+}
+
+template < class T >
+uint scKMeans1D<T>::run(uint itemCount, uint *itemClass)
+{
+  m_itemCount = itemCount;
+  m_realClassCount = 0;
+  m_inertia = 0.0;
+  m_classAvg.clear();
+  m_classUpper.clear();
+
+  if (!itemCount || !prepareValues())
+    return 0;
+
+  const uint valueCount = m_values.size();
+  if (!m_classCount)
+    m_realClassCount = valueCount;
+  else
+    m_realClassCount = std::min<uint>(m_classCount, valueCount);
+
+  prepareSums();
+  findClasses();
+  updateItemClass(itemClass);
+
+  // release memory used by DP
+  std::vector<double>().swap(m_values);
+  std::vector<double>().swap(m_weights);
+  std::vector<double>().swap(m_sumW);
+  std::vector<double>().swap(m_sumX);
+  std::vector<double>().swap(m_sumX2);
+  std::vector<double>().swap(m_prevCost);
+  std::vector<double>().swap(m_currCost);
+  std::vector<uint>().swap(m_split);
+
+  return m_realClassCount;
+}
+
+template < class T >
+double scKMeans1D<T>::loadValue(uint itemIdx) const
+{
+  double res;
+
+  if (m_reader)
+    m_reader->readItem(itemIdx, &res);
+  else
+    res = static_cast<double>(m_input[itemIdx]);
+
+  if (m_transform)
+    m_transform->apply(&res, 1);
+
+  return res;
+}
+
+// sorted distinct values with number of occurences, false if input contains inf or nan
+template < class T >
+bool scKMeans1D<T>::prepareValues()
+{
+  double value;
+  uint valueCount;
+
+  m_values.resize(m_itemCount);
+  for(uint i=0; i != m_itemCount; i++)
+  {
+    value = loadValue(i);
+    if (value - value != 0.0)
+      return false;
+    m_values[i] = value;
+  }
+
+  std::sort(m_values.begin(), m_values.end());
+
+  m_weights.clear();
+  valueCount = 0;
+  for(uint i=0; i != m_itemCount; i++)
+  {
+    if (valueCount && (m_values[valueCount - 1] == m_values[i])) {
+      m_weights[valueCount - 1] += 1.0;
+    } else {
+      m_values[valueCount++] = m_values[i];
+      m_weights.push_back(1.0);
+    }
+  }
+  m_values.resize(valueCount);
+
+  return true;
+}
+
+// prefix sums of values shifted by median, which keeps sum of squares accurate
+template < class T >
+void scKMeans1D<T>::prepareSums()
+{
+  const uint valueCount = m_values.size();
+  double value;
+
+  m_shift = m_values[valueCount / 2];
+  m_sumW.resize(valueCount + 1);
+  m_sumX.resize(valueCount + 1);
+  m_sumX2.resize(valueCount + 1);
+  m_sumW[0] = m_sumX[0] = m_sumX2[0] = 0.0;
+
+  for(uint i=0; i != valueCount; i++)
+  {
+    value = m_values[i] - m_shift;
+    m_sumW[i + 1] = m_sumW[i] + m_weights[i];
+    m_sumX[i + 1] = m_sumX[i] + m_weights[i] * value;
+    m_sumX2[i + 1] = m_sumX2[i] + m_weights[i] * value * value;
+  }
+}
+
+// sum of squares of distinct values [beginPos, endPos] to their average
+template < class T >
+double scKMeans1D<T>::calcCost(uint beginPos, uint endPos) const
+{
+  const double w = m_sumW[endPos + 1] - m_sumW[beginPos];
+  const double s = m_sumX[endPos + 1] - m_sumX[beginPos];
+  const double res = (m_sumX2[endPos + 1] - m_sumX2[beginPos]) - s * s / w;
+  return (res > 0.0) ? res : 0.0;
+}
+
+// cost of values [0, endPos] split into rowIdx + 1 classes, where last class starts at splitPos
+template < class T >
+double scKMeans1D<T>::calcSplitCost(uint splitPos, uint endPos) const
+{
+  if (splitPos > endPos)
+    return HUGE_VAL;
+  return m_prevCost[splitPos - 1] + calcCost(splitPos, endPos);
+}
+
+// Find best split point (leftmost minimum) for each row from rows, using SMAWK.
+// Split cost matrix is totally monotone, so best split does not decrease with row.
+template < class T >
+void scKMeans1D<T>::fillRow(uint rowIdx, const std::vector<uint> &rows, const std::vector<uint> &cols)
+{
+  const uint valueCount = m_values.size();
+  const size_t splitOffset = static_cast<size_t>(rowIdx) * valueCount;
+  std::vector<uint> reducedCols;
+  std::vector<double> reducedCost;
+  std::vector<uint> oddRows;
+  uint endPos, lastCol, colPos, bestSplit;
+  double cost, bestCost;
+
+  if (rows.empty())
+    return;
+
+  // reduce: leave at most one column per row,
+  // cost of each kept column is stored for row at its position
+  reducedCols.reserve(rows.size());
+  reducedCost.reserve(rows.size());
+  for(uint c=0, epos = cols.size(); c != epos; c++)
+  {
+    while (!reducedCols.empty()) {
+      cost = calcSplitCost(cols[c], rows[reducedCols.size() - 1]);
+      if (reducedCost.back() <= cost)
+        break;
+      reducedCols.pop_back();
+      reducedCost.pop_back();
+    }
+    if (reducedCols.size() < rows.size()) {
+      reducedCost.push_back(calcSplitCost(cols[c], rows[reducedCols.size()]));
+      reducedCols.push_back(cols[c]);
+    }
+  }
+
+  // solve odd rows
+  oddRows.reserve(rows.size() / 2);
+  for(uint r=1, epos = rows.size(); r < epos; r += 2)
+    oddRows.push_back(rows[r]);
+  fillRow(rowIdx, oddRows, reducedCols);
+
+  // even rows: search between best splits of neighbour rows
+  colPos = 0;
+  for(uint r=0, epos = rows.size(); r < epos; r += 2)
+  {
+    endPos = rows[r];
+    lastCol = (r + 1 < epos) ? m_split[splitOffset + rows[r + 1]] : reducedCols.back();
+    bestSplit = reducedCols[colPos];
+    bestCost = calcSplitCost(bestSplit, endPos);
+    while (reducedCols[colPos] != lastCol) {
+      colPos++;
+      cost = calcSplitCost(reducedCols[colPos], endPos);
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestSplit = reducedCols[colPos];
+      }
+    }
+    m_currCost[endPos] = bestCost;
+    m_split[splitOffset + endPos] = bestSplit;
+  }
+}
+
+template < class T >
+void scKMeans1D<T>::findClasses()
+{
+  const uint valueCount = m_values.size();
+  const uint classCount = m_realClassCount;
+  std::vector<uint> rows, cols;
+  uint endPos, beginPos;
+
+  m_classAvg.resize(classCount);
+  m_classUpper.resize(classCount);
+
+  // one class per distinct value
+  if (classCount == valueCount) {
+    m_classAvg = m_values;
+    m_classUpper = m_values;
+    m_inertia = 0.0;
+    return;
+  }
+
+  m_split.resize(static_cast<size_t>(classCount) * valueCount);
+  m_prevCost.resize(valueCount);
+  m_currCost.resize(valueCount);
+
+  for(uint i=0; i != valueCount; i++)
+  {
+    m_currCost[i] = calcCost(0, i);
+    m_split[i] = 0;
+  }
+
+  // row q: values [0, i] in q + 1 classes, i >= q; only last value is needed in last row
+  for(uint q=1; q < classCount; q++)
+  {
+    m_prevCost.swap(m_currCost);
+    cols.clear();
+    for(uint j=q; j != valueCount; j++)
+      cols.push_back(j);
+    if (q + 1 < classCount)
+      rows = cols;
+    else
+      rows.assign(1, valueCount - 1);
+    fillRow(q, rows, cols);
+  }
+
+  m_inertia = m_currCost[valueCount - 1];
+
+  endPos = valueCount - 1;
+  for(uint q=classCount; q > 0; q--)
+  {
+    beginPos = m_split[static_cast<size_t>(q - 1) * valueCount + endPos];
+    m_classAvg[q - 1] = m_shift + (m_sumX[endPos + 1] - m_sumX[beginPos]) / (m_sumW[endPos + 1] - m_sumW[beginPos]);
+    m_classUpper[q - 1] = m_values[endPos];
+    if (beginPos > 0)
+      endPos = beginPos - 1;
+  }
+}
+
+template < class T >
+void scKMeans1D<T>::updateItemClass(uint *itemClass) const
+{
+  for(uint i=0; i != m_itemCount; i++)
+    itemClass[i] = static_cast<uint>(
+      std::lower_bound(m_classUpper.begin(), m_classUpper.end(), loadValue(i)) - m_classUpper.begin());
+}
+
+// ----------------------------------------------------------------------------
+// Explicit instantiation
+// ----------------------------------------------------------------------------
+template class scKMeans1D<double>;
+template class scKMeans1D<float>;
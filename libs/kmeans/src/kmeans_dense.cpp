@@ -0,0 +1,1525 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_dense.cpp
+// Project:     scLib
+// Purpose:     Clustering using k-means on dense row-major matrices.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <set>
+#include <cmath>
+#include <algorithm>
+
+//base
+#include "base/rand.h"
+#include "base/bmath.h"
+
+//sc
+#include "sc/alg/kmeans_dense.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// Functions
+// ----------------------------------------------------------------------------
+void calcKMeansClassScale(const double *classAvg, uint classCount, uint dimCount,
+  std::vector<double> &classSpace, std::vector<double> &classScale)
+{
+  std::vector<double> classMin(classAvg, classAvg + dimCount);
+  std::vector<double> classMax(classMin);
+  const double *avgPtr;
+  double value;
+
+  // find dim min and max
+  for(uint j=1; j < classCount; j++)
+  {
+    avgPtr = classAvg + static_cast<size_t>(j) * dimCount;
+    for(uint k=0; k != dimCount; k++)
+    {
+      value = avgPtr[k];
+      if (value < classMin[k])
+        classMin[k] = value;
+      if (value > classMax[k])
+        classMax[k] = value;
+    }
+  }
+
+  // find dim space
+  classSpace.resize(dimCount);
+  classScale.resize(dimCount);
+  for(uint k=0; k != dimCount; k++)
+  {
+    if (classMin[k] == classMax[k])
+      classSpace[k] = 1.0;
+    else
+      classSpace[k] = fpAbs(classMin[k] - classMax[k]);
+    classScale[k] = 1.0 / classSpace[k];
+  }
+}
+
+// ----------------------------------------------------------------------------
+// scDenseKMeans
+// ----------------------------------------------------------------------------
+template < class T >
+scDenseKMeans<T>::scDenseKMeans()
+{
+  m_classCount = KMEANS_DEF_CLASS_COUNT;
+  m_stepLimit = KMEANS_DEF_STEP_LIMIT;
+  m_threadCount = 1;
+  m_seed = 0;
+  m_seedEnabled = false;
+  m_randomSource = NULL;
+  m_simdLevel = ksl_auto;
+  m_accelMode = kam_none;
+  m_initMode = kim_random;
+  m_initRoundCount = KMEANS_DEF_INIT_ROUND_COUNT;
+  m_initOversampling = 0.0;
+  m_transform = NULL;
+  m_incrementalUpdate = false;
+  m_tolerance = 0.0;
+  m_input = NULL;
+  m_reader = NULL;
+  m_itemCount = 0;
+  m_dimCount = 0;
+  m_realClassCount = 0;
+  m_stepNo = 0;
+  m_reproducible = false;
+  m_runSeed = 0;
+  m_blockSize = 0;
+  m_blockCount = 0;
+  m_distanceKernel = NULL;
+  m_classStride = 0;
+  m_boundsValid = false;
+  m_sumsValid = false;
+  m_scaleRatioMin = m_scaleRatioMax = 1.0;
+  m_maxDriftIdx = 0;
+  m_maxDrift = m_maxDrift2 = 0.0;
+}
+
+template < class T >
+void scDenseKMeans<T>::setClassCount(uint value)
+{
+  m_classCount = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setStepLimit(uint value)
+{
+  m_stepLimit = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setThreadCount(uint value)
+{
+  m_threadCount = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setSeed(uint64 value)
+{
+  m_seed = value;
+  m_seedEnabled = true;
+}
+
+template < class T >
+void scDenseKMeans<T>::setRandomGenerator(scRandomGenerator *value)
+{
+  m_randomSource = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setSimdLevel(scKMeansSimdLevel value)
+{
+  m_simdLevel = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setAccelMode(scKMeansAccelMode value)
+{
+  m_accelMode = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setInitMode(scKMeansInitMode value)
+{
+  m_initMode = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setInitRoundCount(uint value)
+{
+  m_initRoundCount = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setInitOversampling(double value)
+{
+  m_initOversampling = value;
+}
+
+template < class T >
+uint scDenseKMeans<T>::getStepCount() const
+{
+  return m_stepNo;
+}
+
+template < class T >
+const std::vector<double> &scDenseKMeans<T>::getClassAvg() const
+{
+  return m_classAvg;
+}
+
+template < class T >
+const std::vector<scKMeansStepStats> &scDenseKMeans<T>::getStepStats() const
+{
+  return m_stepStats;
+}
+
+// blocks are summed in order, so result does not depend on number of threads
+template < class T >
+double scDenseKMeans<T>::calcInertia(const uint *itemClass) const
+{
+  const int blockCount = static_cast<int>(m_blockCount);
+  std::vector<double> blockSums(m_blockCount, 0.0);
+  double res = 0.0;
+
+  if (!m_realClassCount || !m_dimCount)
+    return 0.0;
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(blockCount > 1)
+  for(int b = 0; b < blockCount; b++)
+  {
+    const uint beginPos = static_cast<uint>(b) * m_blockSize;
+    const uint endPos = std::min<uint>(m_itemCount, beginPos + m_blockSize);
+    std::vector<double> element(m_dimCount);
+    const double *avgPtr;
+    double blockSum = 0.0;
+    double diff;
+
+    for(uint i=beginPos; i != endPos; i++)
+    {
+      loadItem(i, &element[0]);
+      avgPtr = &m_classAvg[static_cast<size_t>(itemClass[i]) * m_dimCount];
+      for(uint k=0; k != m_dimCount; k++)
+      {
+        diff = element[k] - avgPtr[k];
+        blockSum += diff * diff;
+      }
+    }
+    blockSums[b] = blockSum;
+  }
+
+  for(uint b=0; b != m_blockCount; b++)
+    res += blockSums[b];
+
+  return res;
+}
+
+template < class T >
+void scDenseKMeans<T>::setTransform(const scKMeansFeatureTransform *value)
+{
+  m_transform = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setInputScale(const std::vector<double> &scale, const std::vector<double> &offset)
+{
+  m_inputScale = scale;
+  m_inputOffset = offset;
+}
+
+template < class T >
+void scDenseKMeans<T>::setIncrementalUpdate(bool value)
+{
+  m_incrementalUpdate = value;
+}
+
+template < class T >
+void scDenseKMeans<T>::setTolerance(double value)
+{
+  m_tolerance = value;
+}
+
+template < class T >
+uint scDenseKMeans<T>::execute(const T *input, uint itemCount, uint dimCount, uint *itemClass)
+{
+  m_input = input;
+  m_reader = NULL;
+  return run(itemCount, dimCount, itemClass);
+}
+
+template < class T >
+uint scDenseKMeans<T>::execute(const scKMeansItemReader &input, uint itemCount, uint dimCount, uint *itemClass)
+{
+  m_input = NULL;
+  m_reader = &input;
+  return run(itemCount, dimCount, itemClass);
+}
+
+template < class T >
+uint scDenseKMeans<T>::run(uint itemCount, uint dimCount, uint *itemClass)
+{
+  uint changedAvgCount;
+
+  m_itemCount = itemCount;
+  m_dimCount = dimCount;
+  m_stepNo = 0;
+  m_classAvg.clear();
+  m_stepStats.clear();
+  m_boundsValid = false;
+  m_upperBound.clear();
+  m_lowerBound.clear();
+  m_lowerBoundStep.clear();
+  m_scaleRatioHistory.clear();
+  m_driftHistory.clear();
+  m_sumsValid = false;
+  m_classSums.clear();
+  m_classCounts.clear();
+  m_treeIndex.clear();
+  m_treeFrontier.clear();
+
+  if (!m_classCount)
+    m_realClassCount = itemCount;
+  else
+    m_realClassCount = std::min<uint>(m_classCount, itemCount);
+
+  if (!m_realClassCount || !m_dimCount)
+    return 0;
+
+  for(uint i=0; i != itemCount; i++)
+    itemClass[i] = 0;
+
+  // without seed and threads global generator is used, as in scKMeansCalculator
+  m_reproducible = m_seedEnabled || (m_randomSource != NULL) || (getWorkerCount() != 1);
+  if (m_seedEnabled)
+    m_runSeed = m_seed;
+  else if (m_randomSource)
+    m_runSeed = m_randomSource->next();
+  else if (m_reproducible)
+    m_runSeed = randomHash(randomUInt64());
+  // random init draws from global generator only, sequence must not be shifted
+  if (m_reproducible)
+    m_random.seed(m_runSeed);
+  else if (m_initMode != kim_random)
+    m_random.seed(randomHash(randomUInt64()));
+
+  m_distanceKernel = getKMeansDistanceKernel(m_simdLevel);
+  m_classStride = calcKMeansClassStride(m_realClassCount);
+
+  if ((m_accelMode == kam_hamerly) || (m_accelMode == kam_elkan)) {
+    m_upperBound.resize(itemCount);
+    if (m_accelMode == kam_elkan) {
+      m_lowerBound.resize(static_cast<size_t>(itemCount) * m_realClassCount);
+      m_lowerBoundStep.resize(itemCount);
+    } else
+      m_lowerBound.resize(itemCount);
+  }
+
+  prepareBlocks();
+  if (m_accelMode == kam_kdtree) {
+    buildTree();
+    prepareTreeFrontier();
+  }
+
+  initAvg();
+  // drawn after initialization, so it uses the same values of global generator
+  if (!m_reproducible && (m_accelMode == kam_kdtree))
+    m_runSeed = randomHash(randomUInt64());
+  do {
+    if (m_accelMode == kam_kdtree)
+      updateItemClassTree(itemClass);
+    else
+      updateItemClass(itemClass);
+    changedAvgCount = updateAvg();
+    m_stepNo++;
+  } while((changedAvgCount > 0) && (m_stepNo < m_stepLimit));
+
+  if (m_accelMode == kam_kdtree)
+    assignTreeNode(0, itemClass);
+
+  return m_realClassCount;
+}
+
+template < class T >
+void scDenseKMeans<T>::loadItem(uint itemIdx, double *output) const
+{
+  if (m_reader) {
+    m_reader->readItem(itemIdx, output);
+  } else if (m_inputScale.empty()) {
+    const T *row = m_input + static_cast<size_t>(itemIdx) * m_dimCount;
+    for(uint k=0; k != m_dimCount; k++)
+      output[k] = static_cast<double>(row[k]);
+  } else {
+    const T *row = m_input + static_cast<size_t>(itemIdx) * m_dimCount;
+    for(uint k=0; k != m_dimCount; k++)
+      output[k] = static_cast<double>(row[k]) * m_inputScale[k] + m_inputOffset[k];
+  }
+
+  if (m_transform)
+    m_transform->apply(output, m_dimCount);
+}
+
+template < class T >
+void scDenseKMeans<T>::initAvg()
+{
+  m_classAvg.resize(static_cast<size_t>(m_realClassCount) * m_dimCount);
+
+  switch (m_initMode) {
+    case kim_plus_plus:
+      initAvgPlusPlus();
+      break;
+    case kim_parallel:
+      initAvgParallel();
+      break;
+    default:
+      initAvgRandom();
+  }
+
+  m_itemWeights.clear();
+  m_blockWeights.clear();
+}
+
+template < class T >
+void scDenseKMeans<T>::initAvgRandom()
+{
+  std::set<uint> centroids;
+  uint randomPoint;
+  uint64 drawNo = 0;
+
+  do {
+    if (m_reproducible)
+      randomPoint = static_cast<uint>(randomHash(m_runSeed + (drawNo++)) % m_itemCount);
+    else
+      randomPoint = randomUInt(0, m_itemCount - 1);
+    centroids.insert(randomPoint);
+  } while ((centroids.size() < m_realClassCount) && (centroids.size() < m_itemCount));
+
+  uint classIdx = 0;
+  for(std::set<uint>::const_iterator it = centroids.begin(), epos = centroids.end(); it != epos; ++it)
+  {
+    loadItem(*it, &m_classAvg[static_cast<size_t>(classIdx) * m_dimCount]);
+    classIdx++;
+  }
+}
+
+// scale used by initialization: 1 / range of input in each dimension
+template < class T >
+void scDenseKMeans<T>::prepareInitScale()
+{
+  std::vector<double> element(m_dimCount);
+  std::vector<double> dimMin, dimMax;
+
+  for(uint i=0; i != m_itemCount; i++)
+  {
+    loadItem(i, &element[0]);
+    if (!i) {
+      dimMin = dimMax = element;
+      continue;
+    }
+    for(uint k=0; k != m_dimCount; k++)
+    {
+      if (element[k] < dimMin[k])
+        dimMin[k] = element[k];
+      if (element[k] > dimMax[k])
+        dimMax[k] = element[k];
+    }
+  }
+
+  m_initScale.resize(m_dimCount);
+  for(uint k=0; k != m_dimCount; k++)
+  {
+    if (dimMin[k] == dimMax[k])
+      m_initScale[k] = 1.0;
+    else
+      m_initScale[k] = 1.0 / fpAbs(dimMax[k] - dimMin[k]);
+  }
+}
+
+// update distance from each item to closest center, returns sum of distances
+template < class T >
+double scDenseKMeans<T>::updateItemWeights(const double *centers, uint centerCount, bool resetWeights)
+{
+  const int blockCount = static_cast<int>(m_blockCount);
+  const uint centerStride = calcKMeansClassStride(centerCount);
+  const bool useKernel = (centerCount > 1);
+  std::vector<double> centersT;
+  double res = 0.0;
+
+  if (resetWeights)
+    m_itemWeights.assign(m_itemCount, HUGE_VAL);
+  m_blockWeights.resize(m_blockCount);
+  if (useKernel)
+    transposeKMeansClassAvg(centers, centerCount, m_dimCount, centersT);
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(blockCount > 1)
+  for(int b = 0; b < blockCount; b++)
+  {
+    const uint beginPos = static_cast<uint>(b) * m_blockSize;
+    const uint endPos = std::min<uint>(m_itemCount, beginPos + m_blockSize);
+    std::vector<double> element(m_dimCount);
+    std::vector<double> distances(centerStride);
+    double blockSum = 0.0;
+
+    for(uint i=beginPos; i != endPos; i++)
+    {
+      loadItem(i, &element[0]);
+      if (useKernel)
+        m_distanceKernel(&element[0], &centersT[0], &m_initScale[0], m_dimCount, centerStride, &distances[0]);
+      else
+        distances[0] = calcKMeansDistance(&element[0], centers, &m_initScale[0], m_dimCount);
+      for(uint c=0; c != centerCount; c++)
+        if (distances[c] < m_itemWeights[i])
+          m_itemWeights[i] = distances[c];
+      blockSum += m_itemWeights[i];
+    }
+    m_blockWeights[b] = blockSum;
+  }
+
+  for(uint b=0; b != m_blockCount; b++)
+    res += m_blockWeights[b];
+  return res;
+}
+
+// find item for which cumulated weight reaches target
+template < class T >
+uint scDenseKMeans<T>::pickWeightedItem(double target)
+{
+  uint b = 0;
+  uint lastPositive = m_itemCount;
+
+  while((b + 1 < m_blockCount) && (target >= m_blockWeights[b]))
+  {
+    target -= m_blockWeights[b];
+    b++;
+  }
+
+  for(uint i=b * m_blockSize, epos = std::min<uint>(m_itemCount, (b + 1) * m_blockSize); i != epos; i++)
+  {
+    if (m_itemWeights[i] > 0.0) {
+      lastPositive = i;
+      if (target < m_itemWeights[i])
+        return i;
+      target -= m_itemWeights[i];
+    }
+  }
+
+  // rounding of block sums
+  if (lastPositive != m_itemCount)
+    return lastPositive;
+  return m_random.randomUInt(0, m_itemCount - 1);
+}
+
+template < class T >
+void scDenseKMeans<T>::initAvgPlusPlus()
+{
+  double totalWeight;
+  uint itemIdx;
+
+  prepareInitScale();
+
+  itemIdx = m_random.randomUInt(0, m_itemCount - 1);
+  loadItem(itemIdx, &m_classAvg[0]);
+
+  for(uint j=1; j < m_realClassCount; j++)
+  {
+    totalWeight = updateItemWeights(&m_classAvg[static_cast<size_t>(j - 1) * m_dimCount], 1, (j == 1));
+    if (totalWeight > 0.0)
+      itemIdx = pickWeightedItem(m_random.nextDouble() * totalWeight);
+    else
+      // less distinct items than classes
+      itemIdx = m_random.randomUInt(0, m_itemCount - 1);
+    loadItem(itemIdx, &m_classAvg[static_cast<size_t>(j) * m_dimCount]);
+  }
+}
+
+template < class T >
+void scDenseKMeans<T>::initAvgParallel()
+{
+  const int blockCount = static_cast<int>(m_blockCount);
+  const double oversampling = (m_initOversampling > 0.0) ? m_initOversampling : 2.0 * m_realClassCount;
+  std::vector<double> candidates(m_dimCount);
+  std::vector<double> candidateWeights;
+  std::vector< std::vector<uint> > blockPicks(m_blockCount);
+  uint newCenterPos = 0;
+  double totalWeight;
+
+  prepareInitScale();
+
+  loadItem(m_random.randomUInt(0, m_itemCount - 1), &candidates[0]);
+
+  // sampling rounds
+  for(uint round = 0; round != m_initRoundCount; round++)
+  {
+    totalWeight = updateItemWeights(&candidates[static_cast<size_t>(newCenterPos) * m_dimCount], 
+      static_cast<uint>(candidates.size() / m_dimCount) - newCenterPos, (round == 0));
+    if (totalWeight <= 0.0)
+      break;
+
+    const uint64 roundKey = randomHash(m_random.next());
+    newCenterPos = static_cast<uint>(candidates.size() / m_dimCount);
+
+    // items are sampled independently, so result does not depend on threads
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(blockCount > 1)
+    for(int b = 0; b < blockCount; b++)
+    {
+      const uint beginPos = static_cast<uint>(b) * m_blockSize;
+      const uint endPos = std::min<uint>(m_itemCount, beginPos + m_blockSize);
+      double prob;
+      blockPicks[b].clear();
+      for(uint i=beginPos; i != endPos; i++)
+      {
+        prob = oversampling * m_itemWeights[i] / totalWeight;
+        if (static_cast<double>(randomHash(roundKey + i) >> 11) * (1.0 / 9007199254740992.0) < prob)
+          blockPicks[b].push_back(i);
+      }
+    }
+
+    for(uint b=0; b != m_blockCount; b++)
+      for(uint p=0, epos = blockPicks[b].size(); p != epos; p++)
+      {
+        candidates.resize(candidates.size() + m_dimCount);
+        loadItem(blockPicks[b][p], &candidates[candidates.size() - m_dimCount]);
+      }
+
+    if (newCenterPos == candidates.size() / m_dimCount)
+      break;
+  }
+
+  // weight of candidate = number of items closest to it
+  const uint candidateCount = static_cast<uint>(candidates.size() / m_dimCount);
+  const uint candidateStride = calcKMeansClassStride(candidateCount);
+  std::vector<double> candidatesT;
+  std::vector<uint> blockCounts(static_cast<size_t>(m_blockCount) * candidateCount, 0);
+
+  transposeKMeansClassAvg(&candidates[0], candidateCount, m_dimCount, candidatesT);
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(blockCount > 1)
+  for(int b = 0; b < blockCount; b++)
+  {
+    const uint beginPos = static_cast<uint>(b) * m_blockSize;
+    const uint endPos = std::min<uint>(m_itemCount, beginPos + m_blockSize);
+    std::vector<double> element(m_dimCount);
+    std::vector<double> distances(candidateStride);
+    uint *countPtr = &blockCounts[static_cast<size_t>(b) * candidateCount];
+    uint bestIdx;
+
+    for(uint i=beginPos; i != endPos; i++)
+    {
+      loadItem(i, &element[0]);
+      m_distanceKernel(&element[0], &candidatesT[0], &m_initScale[0], m_dimCount, candidateStride, &distances[0]);
+      bestIdx = 0;
+      for(uint c=1; c < candidateCount; c++)
+        if (distances[c] < distances[bestIdx])
+          bestIdx = c;
+      countPtr[bestIdx]++;
+    }
+  }
+
+  candidateWeights.assign(candidateCount, 0.0);
+  for(uint b=0; b != m_blockCount; b++)
+    for(uint c=0; c != candidateCount; c++)
+      candidateWeights[c] += blockCounts[static_cast<size_t>(b) * candidateCount + c];
+
+  selectWeightedCenters(candidates, candidateWeights);
+}
+
+// weighted k-means++ on candidates found by k-means||
+template < class T >
+void scDenseKMeans<T>::selectWeightedCenters(const std::vector<double> &candidates, const std::vector<double> &candidateWeights)
+{
+  const uint candidateCount = candidateWeights.size();
+  std::vector<double> minDist(candidateCount, HUGE_VAL);
+  std::vector<double> pickWeights(candidateWeights);
+  const double *centerPtr;
+  double totalWeight, target, distance;
+  uint pickIdx;
+
+  for(uint j=0; j != m_realClassCount; j++)
+  {
+    totalWeight = 0.0;
+    for(uint c=0; c != candidateCount; c++)
+      totalWeight += pickWeights[c];
+
+    pickIdx = candidateCount - 1;
+    if (totalWeight > 0.0) {
+      target = m_random.nextDouble() * totalWeight;
+      for(uint c=0; c != candidateCount; c++)
+      {
+        if ((pickWeights[c] > 0.0) && (target < pickWeights[c])) {
+          pickIdx = c;
+          break;
+        }
+        target -= pickWeights[c];
+      }
+    } else {
+      // less distinct candidates than classes
+      pickIdx = m_random.randomUInt(0, candidateCount - 1);
+    }
+
+    centerPtr = &candidates[static_cast<size_t>(pickIdx) * m_dimCount];
+    std::copy(centerPtr, centerPtr + m_dimCount, m_classAvg.begin() + static_cast<size_t>(j) * m_dimCount);
+
+    for(uint c=0; c != candidateCount; c++)
+    {
+      distance = calcKMeansDistance(&candidates[static_cast<size_t>(c) * m_dimCount], centerPtr, 
+        &m_initScale[0], m_dimCount);
+      if (distance < minDist[c])
+        minDist[c] = distance;
+      pickWeights[c] = candidateWeights[c] * minDist[c];
+    }
+  }
+}
+
+template < class T >
+void scDenseKMeans<T>::calcClassSpace()
+{
+  calcKMeansClassScale(&m_classAvg[0], m_realClassCount, m_dimCount, m_classSpace, m_classScale);
+}
+
+template < class T >
+uint scDenseKMeans<T>::getWorkerCount() const
+{
+#ifdef _OPENMP
+  if (!m_threadCount)
+    return omp_get_max_threads();
+#endif
+  return m_threadCount ? m_threadCount : 1;
+}
+
+// split items into blocks, layout does not depend on number of threads
+template < class T >
+void scDenseKMeans<T>::prepareBlocks()
+{
+  if (!m_reproducible) {
+    m_blockSize = m_itemCount;
+    m_blockCount = 1;
+    return;
+  }
+
+  size_t sumsSize = static_cast<size_t>(m_realClassCount) * m_dimCount;
+  uint maxBlockCount = std::max<uint>(1, 
+    std::min<uint>(KMEANS_MAX_BLOCK_COUNT, static_cast<uint>(KMEANS_MAX_BLOCK_SUMS_SIZE / sumsSize)));
+
+  m_blockSize = std::max<uint>(KMEANS_MIN_BLOCK_SIZE, (m_itemCount + maxBlockCount - 1) / maxBlockCount);
+  m_blockCount = (m_itemCount + m_blockSize - 1) / m_blockSize;
+}
+
+template < class T >
+uint scDenseKMeans<T>::getTieBreakIndex(uint itemIdx, uint tieCount) const
+{
+  // k-d tree visits items in tree order, sequence of global generator would depend on it
+  if (!m_reproducible && (m_accelMode != kam_kdtree))
+    return randomUInt(0, tieCount - 1);
+  uint64 stepKey = randomHash(m_runSeed ^ (static_cast<uint64>(m_stepNo + 1) << 32));
+  return static_cast<uint>(randomHash(stepKey + itemIdx) % tieCount);
+}
+
+// assign items to classes and calculate partial sums for each block
+template < class T >
+void scDenseKMeans<T>::updateItemClass(uint *itemClass)
+{
+  const int blockCount = static_cast<int>(m_blockCount);
+  const size_t sumsSize = m_classAvg.size();
+  scKMeansStepStats stepStats;
+
+  calcClassSpace();
+  transposeKMeansClassAvg(&m_classAvg[0], m_realClassCount, m_dimCount, m_classAvgT);
+  if (m_accelMode != kam_none)
+    prepareBounds();
+
+  m_blockSums.assign(sumsSize * m_blockCount, 0.0);
+  m_blockCounts.assign(static_cast<size_t>(m_realClassCount) * m_blockCount, 0);
+  stepStats.distanceCount = stepStats.skippedCount = 0;
+  stepStats.changedCount = 0;
+  m_blockStats.assign(m_blockCount, stepStats);
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(blockCount > 1)
+  for(int b = 0; b < blockCount; b++)
+    updateBlock(static_cast<uint>(b), itemClass);
+
+  for(uint b=0; b != m_blockCount; b++)
+  {
+    stepStats.distanceCount += m_blockStats[b].distanceCount;
+    stepStats.skippedCount += m_blockStats[b].skippedCount;
+    stepStats.changedCount += m_blockStats[b].changedCount;
+  }
+  m_stepStats.push_back(stepStats);
+
+  if (m_accelMode != kam_none)
+    saveBoundsBase();
+}
+
+template < class T >
+void scDenseKMeans<T>::updateBlock(uint blockIdx, uint *itemClass)
+{
+  const uint beginPos = blockIdx * m_blockSize;
+  const uint endPos = std::min<uint>(m_itemCount, beginPos + m_blockSize);
+  double *blockSums = &m_blockSums[m_classAvg.size() * blockIdx];
+  uint *blockCounts = &m_blockCounts[static_cast<size_t>(m_realClassCount) * blockIdx];
+  scKMeansStepStats &stats = m_blockStats[blockIdx];
+  std::vector<double> element(m_dimCount);
+  std::vector<double> distances(m_classStride);
+  std::vector<uint> itemClassSet;
+  double *sumPtr;
+  uint bestClassIdx, oldClassIdx;
+  bool elementLoaded;
+
+  itemClassSet.reserve(m_realClassCount);
+
+  for(uint i=beginPos; i != endPos; i++)
+  {
+    oldClassIdx = itemClass[i];
+    elementLoaded = false;
+
+    if (!m_boundsValid) {
+      loadItem(i, &element[0]);
+      elementLoaded = true;
+      bestClassIdx = findClassFull(i, &element[0], &distances[0], itemClassSet, stats);
+    } else if (m_accelMode == kam_elkan) {
+      bestClassIdx = findClassElkan(i, oldClassIdx, &element[0], elementLoaded, &distances[0], itemClassSet, stats);
+    } else {
+      bestClassIdx = findClassHamerly(i, oldClassIdx, &element[0], elementLoaded, &distances[0], itemClassSet, stats);
+    }
+
+    if (oldClassIdx != bestClassIdx)
+      stats.changedCount++;
+    itemClass[i] = bestClassIdx;
+
+    // incremental sums change only for items which changed class, others may be not read at all
+    if (m_sumsValid && (oldClassIdx == bestClassIdx))
+      continue;
+
+    if (!elementLoaded)
+      loadItem(i, &element[0]);
+
+    if (m_sumsValid) {
+      // incremental: move item between classes, decrement of count wraps around
+      // but sum of block counts is still exact
+      sumPtr = &blockSums[static_cast<size_t>(oldClassIdx) * m_dimCount];
+      for(uint k=0; k != m_dimCount; k++)
+        sumPtr[k] -= element[k];
+      blockCounts[oldClassIdx]--;
+    }
+
+    // count + sum
+    sumPtr = &blockSums[static_cast<size_t>(bestClassIdx) * m_dimCount];
+    for(uint k=0; k != m_dimCount; k++)
+      sumPtr[k] += element[k];
+    blockCounts[bestClassIdx]++;
+  } // for i
+}
+
+// Find closest class, on equal distance select one of them randomly.
+// Kernel distances use 1/classSpace and are not square-rooted, so classes
+// nearly as close as best one are compared again with exact distance of
+// original calculator (division, sqrt) - result does not depend on kernel.
+template < class T >
+uint scDenseKMeans<T>::selectBestClass(uint itemIdx, const double *element, const double *distances,
+  std::vector<uint> &itemClassSet) const
+{
+  const uint classCnt = m_realClassCount;
+  uint bestClassIdx = 0;
+  uint nearCount = 0;
+  double bestClassDist, distance, limit;
+
+  itemClassSet.clear();
+
+  for(uint j=1; j < classCnt; j++)
+    if (distances[j] < distances[bestClassIdx])
+      bestClassIdx = j;
+
+  limit = distances[bestClassIdx] * (1.0 + KMEANS_TIE_MARGIN_PER_DIM * (m_dimCount + 4));
+  for(uint j=0; j != classCnt; j++)
+    if (distances[j] <= limit)
+      nearCount++;
+
+  if (nearCount <= 1)
+    return bestClassIdx;
+
+  bestClassIdx = classCnt;
+  bestClassDist = 0.0;
+  for(uint j=0; j != classCnt; j++)
+  {
+    if (!(distances[j] <= limit))
+      continue;
+    distance = sqrt(calcKMeansExactDistance(element, &m_classAvg[static_cast<size_t>(j) * m_dimCount],
+      &m_classSpace[0], m_dimCount));
+    if ((bestClassIdx == classCnt) || (distance < bestClassDist))
+    {
+      bestClassIdx = j;
+      bestClassDist = distance;
+      itemClassSet.clear();
+    } else if (distance == bestClassDist)
+    {
+      if (itemClassSet.empty())
+        itemClassSet.push_back(bestClassIdx);
+      itemClassSet.push_back(j);
+    }
+  }
+
+  // classes are collected in ascending order, same as std::set would keep them
+  if (!itemClassSet.empty())
+    bestClassIdx = itemClassSet[getTieBreakIndex(itemIdx, itemClassSet.size())];
+
+  return bestClassIdx;
+}
+
+template < class T >
+uint scDenseKMeans<T>::findClassFull(uint itemIdx, const double *element, double *distances, 
+  std::vector<uint> &itemClassSet, scKMeansStepStats &stats)
+{
+  const uint classCnt = m_realClassCount;
+  uint res;
+
+  m_distanceKernel(element, &m_classAvgT[0], &m_classScale[0], m_dimCount, m_classStride, distances);
+  stats.distanceCount += classCnt;
+  res = selectBestClass(itemIdx, element, distances, itemClassSet);
+
+  if (m_accelMode == kam_hamerly) {
+    double secondDist = HUGE_VAL;
+    for(uint j=0; j != classCnt; j++)
+      if ((j != res) && (distances[j] < secondDist))
+        secondDist = distances[j];
+    m_upperBound[itemIdx] = sqrt(distances[res]);
+    m_lowerBound[itemIdx] = sqrt(secondDist);
+  } else if (m_accelMode == kam_elkan) {
+    double *lowerPtr = &m_lowerBound[static_cast<size_t>(itemIdx) * classCnt];
+    for(uint j=0; j != classCnt; j++)
+      lowerPtr[j] = sqrt(distances[j]);
+    m_lowerBoundStep[itemIdx] = m_scaleRatioHistory.size();
+    m_upperBound[itemIdx] = lowerPtr[res];
+  }
+
+  return res;
+}
+
+// true if a < b with margin for rounding errors, false for negative b
+inline bool isBoundBelow(double a, double b)
+{
+  return (a * (1.0 + KMEANS_BOUND_MARGIN) < b * (1.0 - KMEANS_BOUND_MARGIN));
+}
+
+template < class T >
+uint scDenseKMeans<T>::findClassHamerly(uint itemIdx, uint oldClassIdx, double *element, bool &elementLoaded, 
+  double *distances, std::vector<uint> &itemClassSet, scKMeansStepStats &stats)
+{
+  const uint classCnt = m_realClassCount;
+  double upper = m_upperBound[itemIdx] * m_scaleRatioMax + m_classDrift[oldClassIdx];
+  double lower = m_lowerBound[itemIdx] * m_scaleRatioMin - 
+    ((oldClassIdx == m_maxDriftIdx) ? m_maxDrift2 : m_maxDrift);
+  double limit = std::max<double>(lower, m_classHalfMin[oldClassIdx]);
+
+  m_upperBound[itemIdx] = upper;
+  m_lowerBound[itemIdx] = lower;
+
+  if (isBoundBelow(upper, limit))
+  {
+    stats.skippedCount += classCnt;
+    return oldClassIdx;
+  }
+
+  // tighten upper bound
+  loadItem(itemIdx, element);
+  elementLoaded = true;
+  upper = sqrt(calcKMeansDistance(element, &m_classAvg[static_cast<size_t>(oldClassIdx) * m_dimCount], 
+    &m_classScale[0], m_dimCount));
+  stats.distanceCount++;
+  m_upperBound[itemIdx] = upper;
+
+  if (isBoundBelow(upper, limit))
+  {
+    stats.skippedCount += classCnt - 1;
+    return oldClassIdx;
+  }
+
+  return findClassFull(itemIdx, element, distances, itemClassSet, stats);
+}
+
+template < class T >
+uint scDenseKMeans<T>::findClassElkan(uint itemIdx, uint oldClassIdx, double *element, bool &elementLoaded, 
+  double *distances, std::vector<uint> &itemClassSet, scKMeansStepStats &stats)
+{
+  const uint classCnt = m_realClassCount;
+  double *lowerPtr = &m_lowerBound[static_cast<size_t>(itemIdx) * classCnt];
+  const double *halfDistPtr;
+  double upper = m_upperBound[itemIdx] * m_scaleRatioMax + m_classDrift[oldClassIdx];
+  uint bestClassIdx = oldClassIdx;
+  const uint historyCount = m_scaleRatioHistory.size();
+  const double *driftPtr;
+  uint computedCount = 0;
+
+  // lower bounds are not read here, so skipped item costs O(1)
+  if (isBoundBelow(upper, m_classHalfMin[oldClassIdx]))
+  {
+    m_upperBound[itemIdx] = upper;
+    stats.skippedCount += classCnt;
+    return oldClassIdx;
+  }
+
+  // decay lower bounds by all steps since they were updated, in the same
+  // order as if it was done on each step
+  for(uint s = m_lowerBoundStep[itemIdx]; s != historyCount; s++)
+  {
+    driftPtr = &m_driftHistory[static_cast<size_t>(s) * classCnt];
+    for(uint j=0; j != classCnt; j++)
+      lowerPtr[j] = lowerPtr[j] * m_scaleRatioHistory[s] - driftPtr[j];
+  }
+  m_lowerBoundStep[itemIdx] = historyCount;
+
+  for(uint j=0; j != classCnt; j++)
+    distances[j] = HUGE_VAL;
+
+  for(uint j=0; j != classCnt; j++)
+  {
+    if ((j == bestClassIdx) || (distances[j] != HUGE_VAL))
+      continue;
+
+    halfDistPtr = &m_classHalfDist[static_cast<size_t>(bestClassIdx) * classCnt];
+    if (isBoundBelow(upper, lowerPtr[j]) || isBoundBelow(upper, halfDistPtr[j]))
+      continue;
+
+    if (!computedCount)
+    {
+      // tighten upper bound
+      loadItem(itemIdx, element);
+      elementLoaded = true;
+      distances[bestClassIdx] = calcKMeansDistance(element, &m_classAvg[static_cast<size_t>(bestClassIdx) * m_dimCount], 
+        &m_classScale[0], m_dimCount);
+      computedCount++;
+      upper = lowerPtr[bestClassIdx] = sqrt(distances[bestClassIdx]);
+      if (isBoundBelow(upper, lowerPtr[j]) || isBoundBelow(upper, halfDistPtr[j]))
+        continue;
+    }
+
+    distances[j] = calcKMeansDistance(element, &m_classAvg[static_cast<size_t>(j) * m_dimCount], 
+      &m_classScale[0], m_dimCount);
+    computedCount++;
+    lowerPtr[j] = sqrt(distances[j]);
+    if (distances[j] < distances[bestClassIdx])
+    {
+      bestClassIdx = j;
+      upper = lowerPtr[j];
+    }
+  }
+
+  // equal distances are possible only between calculated ones
+  if (computedCount)
+  {
+    bestClassIdx = selectBestClass(itemIdx, element, distances, itemClassSet);
+    upper = lowerPtr[bestClassIdx];
+  }
+
+  m_upperBound[itemIdx] = upper;
+  stats.distanceCount += computedCount;
+  stats.skippedCount += classCnt - computedCount;
+  return bestClassIdx;
+}
+
+// prepare values used to update bounds: change of metric, class moves and distances between classes
+template < class T >
+void scDenseKMeans<T>::prepareBounds()
+{
+  const uint classCnt = m_realClassCount;
+  double ratio, dist;
+
+  m_classHalfDist.resize(static_cast<size_t>(classCnt) * classCnt);
+  m_classHalfMin.assign(classCnt, HUGE_VAL);
+  m_classDrift.assign(classCnt, 0.0);
+
+  for(uint a=0; a != classCnt; a++)
+  {
+    m_classHalfDist[static_cast<size_t>(a) * classCnt + a] = 0.0;
+    for(uint j=a+1; j != classCnt; j++)
+    {
+      dist = 0.5 * sqrt(calcKMeansDistance(&m_classAvg[static_cast<size_t>(a) * m_dimCount], 
+        &m_classAvg[static_cast<size_t>(j) * m_dimCount], &m_classScale[0], m_dimCount));
+      m_classHalfDist[static_cast<size_t>(a) * classCnt + j] = dist;
+      m_classHalfDist[static_cast<size_t>(j) * classCnt + a] = dist;
+      if (dist < m_classHalfMin[a])
+        m_classHalfMin[a] = dist;
+      if (dist < m_classHalfMin[j])
+        m_classHalfMin[j] = dist;
+    }
+  }
+
+  if (!m_boundsValid)
+    return;
+
+  // distance in new metric vs previous one: ratio of scales
+  m_scaleRatioMin = m_scaleRatioMax = m_classScale[0] / m_prevClassScale[0];
+  for(uint k=1; k < m_dimCount; k++)
+  {
+    ratio = m_classScale[k] / m_prevClassScale[k];
+    if (ratio < m_scaleRatioMin)
+      m_scaleRatioMin = ratio;
+    if (ratio > m_scaleRatioMax)
+      m_scaleRatioMax = ratio;
+  }
+
+  // class moves, measured in new metric
+  m_maxDriftIdx = 0;
+  m_maxDrift = m_maxDrift2 = 0.0;
+  for(uint j=0; j != classCnt; j++)
+  {
+    dist = sqrt(calcKMeansDistance(&m_prevClassAvg[static_cast<size_t>(j) * m_dimCount], 
+      &m_classAvg[static_cast<size_t>(j) * m_dimCount], &m_classScale[0], m_dimCount));
+    m_classDrift[j] = dist;
+    if (dist > m_maxDrift)
+    {
+      m_maxDrift2 = m_maxDrift;
+      m_maxDrift = dist;
+      m_maxDriftIdx = j;
+    } else if (dist > m_maxDrift2) {
+      m_maxDrift2 = dist;
+    }
+  }
+
+  if (m_accelMode == kam_elkan) {
+    m_scaleRatioHistory.push_back(m_scaleRatioMin);
+    m_driftHistory.insert(m_driftHistory.end(), m_classDrift.begin(), m_classDrift.end());
+  }
+}
+
+template < class T >
+void scDenseKMeans<T>::saveBoundsBase()
+{
+  m_prevClassAvg = m_classAvg;
+  m_prevClassScale = m_classScale;
+  m_boundsValid = true;
+}
+
+// ----------------------------------------------------------------------------
+// k-d tree filtering
+// ----------------------------------------------------------------------------
+// extend bounding box by item
+inline void addKMeansTreeItem(const double *element, uint dimCount, double *low, double *high)
+{
+  for(uint k=0; k != dimCount; k++)
+  {
+    if (element[k] < low[k])
+      low[k] = element[k];
+    if (element[k] > high[k])
+      high[k] = element[k];
+  }
+}
+
+// Items are copied in tree order while tree is built, so splits read memory
+// sequentially. Copy is released when tree is ready.
+template < class T >
+void scDenseKMeans<T>::buildTree()
+{
+  std::vector<double> points(static_cast<size_t>(m_itemCount) * m_dimCount);
+  std::vector<double> low(m_dimCount, HUGE_VAL), high(m_dimCount, -HUGE_VAL);
+  double *element;
+
+  m_treeBegin.clear();
+  m_treeEnd.clear();
+  m_treeRight.clear();
+  m_treeLow.clear();
+  m_treeHigh.clear();
+  m_treeSum.clear();
+
+  m_treeIndex.resize(m_itemCount);
+  for(uint i=0; i != m_itemCount; i++)
+  {
+    m_treeIndex[i] = i;
+    element = &points[static_cast<size_t>(i) * m_dimCount];
+    loadItem(i, element);
+    addKMeansTreeItem(element, m_dimCount, &low[0], &high[0]);
+  }
+
+  addTreeNode(0, m_itemCount, &low[0], &high[0]);
+  buildTreeNode(0, 0, &points[0]);
+
+  m_treeClass.assign(m_treeBegin.size(), KMEANS_TREE_MIXED);
+}
+
+template < class T >
+uint scDenseKMeans<T>::addTreeNode(uint beginPos, uint endPos, const double *low, const double *high)
+{
+  m_treeBegin.push_back(beginPos);
+  m_treeEnd.push_back(endPos);
+  m_treeRight.push_back(0);
+  m_treeLow.insert(m_treeLow.end(), low, low + m_dimCount);
+  m_treeHigh.insert(m_treeHigh.end(), high, high + m_dimCount);
+  m_treeSum.resize(m_treeSum.size() + m_dimCount, 0.0);
+  return static_cast<uint>(m_treeBegin.size() - 1);
+}
+
+// Split node at middle of its widest dimension, points are in tree order.
+// Sum of node is calculated from its items in leaves, from children otherwise.
+template < class T >
+void scDenseKMeans<T>::buildTreeNode(uint nodeIdx, uint depth, double *points)
+{
+  const uint beginPos = m_treeBegin[nodeIdx];
+  const uint endPos = m_treeEnd[nodeIdx];
+  const size_t nodeOffset = static_cast<size_t>(nodeIdx) * m_dimCount;
+  uint splitDim = 0;
+  double width = m_treeHigh[nodeOffset] - m_treeLow[nodeOffset];
+  bool isLeaf;
+
+  for(uint k=1; k < m_dimCount; k++)
+    if (m_treeHigh[nodeOffset + k] - m_treeLow[nodeOffset + k] > width) {
+      width = m_treeHigh[nodeOffset + k] - m_treeLow[nodeOffset + k];
+      splitDim = k;
+    }
+
+  // not finite width is also a leaf
+  isLeaf = (endPos - beginPos <= KMEANS_TREE_LEAF_SIZE) || (depth >= KMEANS_TREE_MAX_DEPTH) || !(width > 0.0);
+
+  uint leftPos = beginPos;
+  if (!isLeaf) {
+    const double splitValue = 0.5 * (m_treeLow[nodeOffset + splitDim] + m_treeHigh[nodeOffset + splitDim]);
+    std::vector<double> leftLow(m_dimCount, HUGE_VAL), leftHigh(m_dimCount, -HUGE_VAL);
+    std::vector<double> rightLow(m_dimCount, HUGE_VAL), rightHigh(m_dimCount, -HUGE_VAL);
+    uint rightPos = endPos;
+    double *element, *otherPtr;
+
+    while (leftPos != rightPos) {
+      element = points + static_cast<size_t>(leftPos) * m_dimCount;
+      if (element[splitDim] < splitValue) {
+        addKMeansTreeItem(element, m_dimCount, &leftLow[0], &leftHigh[0]);
+        leftPos++;
+      } else {
+        rightPos--;
+        otherPtr = points + static_cast<size_t>(rightPos) * m_dimCount;
+        std::swap_ranges(element, element + m_dimCount, otherPtr);
+        std::swap(m_treeIndex[leftPos], m_treeIndex[rightPos]);
+        addKMeansTreeItem(otherPtr, m_dimCount, &rightLow[0], &rightHigh[0]);
+      }
+    }
+
+    // middle equal to low bound after rounding
+    isLeaf = (leftPos == beginPos) || (leftPos == endPos);
+
+    if (!isLeaf) {
+      const uint leftIdx = addTreeNode(beginPos, leftPos, &leftLow[0], &leftHigh[0]);
+      buildTreeNode(leftIdx, depth + 1, points);
+      const uint rightIdx = addTreeNode(leftPos, endPos, &rightLow[0], &rightHigh[0]);
+      m_treeRight[nodeIdx] = rightIdx;
+      buildTreeNode(rightIdx, depth + 1, points);
+
+      for(uint k=0; k != m_dimCount; k++)
+        m_treeSum[nodeOffset + k] = m_treeSum[static_cast<size_t>(leftIdx) * m_dimCount + k] + 
+          m_treeSum[static_cast<size_t>(rightIdx) * m_dimCount + k];
+      return;
+    }
+  }
+
+  const double *element;
+  for(uint p=beginPos; p != endPos; p++)
+  {
+    element = points + static_cast<size_t>(p) * m_dimCount;
+    for(uint k=0; k != m_dimCount; k++)
+      m_treeSum[nodeOffset + k] += element[k];
+  }
+}
+
+// Nodes processed in parallel: tree levels are expanded until there are at
+// least as many nodes as blocks. Depends on input only, like block layout.
+template < class T >
+void scDenseKMeans<T>::prepareTreeFrontier()
+{
+  std::vector<uint> nextLevel;
+  bool expanded = true;
+
+  m_treeFrontier.assign(1, 0);
+  while (expanded && (m_treeFrontier.size() < m_blockCount)) {
+    expanded = false;
+    nextLevel.clear();
+    for(uint f=0, epos = m_treeFrontier.size(); f != epos; f++)
+    {
+      const uint nodeIdx = m_treeFrontier[f];
+      if (m_treeRight[nodeIdx]) {
+        nextLevel.push_back(nodeIdx + 1);
+        nextLevel.push_back(m_treeRight[nodeIdx]);
+        expanded = true;
+      } else {
+        nextLevel.push_back(nodeIdx);
+      }
+    }
+    m_treeFrontier.swap(nextLevel);
+  }
+}
+
+// assign classes to frontier subtrees and calculate partial sums for each of them
+template < class T >
+void scDenseKMeans<T>::updateItemClassTree(uint *itemClass)
+{
+  const int frontierCount = static_cast<int>(m_treeFrontier.size());
+  const size_t sumsSize = m_classAvg.size();
+  scKMeansStepStats stepStats;
+
+  calcClassSpace();
+
+  m_blockSums.assign(sumsSize * frontierCount, 0.0);
+  m_blockCounts.assign(static_cast<size_t>(m_realClassCount) * frontierCount, 0);
+  stepStats.distanceCount = stepStats.skippedCount = 0;
+  stepStats.changedCount = 0;
+  m_blockStats.assign(frontierCount, stepStats);
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(frontierCount > 1)
+  for(int f = 0; f < frontierCount; f++)
+  {
+    std::vector<double> element(m_dimCount);
+    std::vector<double> distances(m_realClassCount);
+    std::vector<uint> itemClassSet;
+    std::vector<uint> candidates;
+
+    itemClassSet.reserve(m_realClassCount);
+    candidates.reserve(static_cast<size_t>(m_realClassCount) * 4);
+    for(uint j=0; j != m_realClassCount; j++)
+      candidates.push_back(j);
+
+    filterTreeNode(static_cast<uint>(f), m_treeFrontier[f], KMEANS_TREE_MIXED, 0, candidates, itemClass, 
+      &element[0], &distances[0], itemClassSet);
+  }
+
+  for(int f = 0; f < frontierCount; f++)
+  {
+    stepStats.distanceCount += m_blockStats[f].distanceCount;
+    stepStats.skippedCount += m_blockStats[f].skippedCount;
+    stepStats.changedCount += m_blockStats[f].changedCount;
+  }
+  m_stepStats.push_back(stepStats);
+}
+
+// Candidates of node are stored at end of candidates, from candPos.
+// Classes kept for children are appended after them and removed on return.
+// prevClassIdx is class of ancestor assigned as a whole in previous step.
+template < class T >
+void scDenseKMeans<T>::filterTreeNode(uint blockIdx, uint nodeIdx, uint prevClassIdx, uint candPos, 
+  std::vector<uint> &candidates, uint *itemClass, double *element, double *distances, 
+  std::vector<uint> &itemClassSet)
+{
+  const uint classCnt = m_realClassCount;
+  const uint beginPos = m_treeBegin[nodeIdx];
+  const uint endPos = m_treeEnd[nodeIdx];
+  const double *low = &m_treeLow[static_cast<size_t>(nodeIdx) * m_dimCount];
+  const double *high = &m_treeHigh[static_cast<size_t>(nodeIdx) * m_dimCount];
+  double *blockSums = &m_blockSums[m_classAvg.size() * blockIdx];
+  uint *blockCounts = &m_blockCounts[static_cast<size_t>(classCnt) * blockIdx];
+  scKMeansStepStats &stats = m_blockStats[blockIdx];
+  const uint candCount = static_cast<uint>(candidates.size()) - candPos;
+  const uint keptPos = static_cast<uint>(candidates.size());
+  const double *bestPtr, *avgPtr;
+  double *sumPtr;
+  const double *nodeSumPtr;
+  // class of all items of node in previous step, KMEANS_TREE_MIXED if they differ
+  const uint oldClassIdx = (prevClassIdx != KMEANS_TREE_MIXED) ? prevClassIdx : m_treeClass[nodeIdx];
+  uint bestClassIdx, classIdx, itemIdx, keptCount;
+  double bestDist, distance;
+
+  // class closest to cell center
+  for(uint k=0; k != m_dimCount; k++)
+    element[k] = 0.5 * (low[k] + high[k]);
+  bestClassIdx = candidates[candPos];
+  bestDist = HUGE_VAL;
+  if (candCount > 1) {
+    for(uint c=candPos, epos = candPos + candCount; c != epos; c++)
+    {
+      classIdx = candidates[c];
+      distance = calcKMeansDistance(element, &m_classAvg[static_cast<size_t>(classIdx) * m_dimCount], 
+        &m_classScale[0], m_dimCount);
+      if (distance < bestDist) {
+        bestDist = distance;
+        bestClassIdx = classIdx;
+      }
+    }
+    stats.distanceCount += candCount;
+  }
+
+  // drop classes which are farther than best one from each point of cell,
+  // it is enough to check cell vertex in direction of class
+  bestPtr = &m_classAvg[static_cast<size_t>(bestClassIdx) * m_dimCount];
+  candidates.push_back(bestClassIdx);
+  for(uint c=candPos, epos = candPos + candCount; c != epos; c++)
+  {
+    classIdx = candidates[c];
+    if (classIdx == bestClassIdx)
+      continue;
+    avgPtr = &m_classAvg[static_cast<size_t>(classIdx) * m_dimCount];
+    for(uint k=0; k != m_dimCount; k++)
+      element[k] = (avgPtr[k] > bestPtr[k]) ? high[k] : low[k];
+    if (!isBoundBelow(calcKMeansDistance(element, bestPtr, &m_classScale[0], m_dimCount), 
+         calcKMeansDistance(element, avgPtr, &m_classScale[0], m_dimCount)))
+      candidates.push_back(classIdx);
+    stats.distanceCount += 2;
+  }
+  keptCount = static_cast<uint>(candidates.size()) - keptPos;
+
+  if (keptCount == 1) {
+    // whole node in one class
+    stats.changedCount += countTreeChanges(nodeIdx, oldClassIdx, bestClassIdx, itemClass);
+    m_treeClass[nodeIdx] = bestClassIdx;
+    sumPtr = &blockSums[static_cast<size_t>(bestClassIdx) * m_dimCount];
+    nodeSumPtr = &m_treeSum[static_cast<size_t>(nodeIdx) * m_dimCount];
+    for(uint k=0; k != m_dimCount; k++)
+      sumPtr[k] += nodeSumPtr[k];
+    blockCounts[bestClassIdx] += endPos - beginPos;
+    stats.skippedCount += static_cast<uint64>(endPos - beginPos) * classCnt;
+  } else if (m_treeRight[nodeIdx]) {
+    m_treeClass[nodeIdx] = KMEANS_TREE_MIXED;
+    filterTreeNode(blockIdx, nodeIdx + 1, oldClassIdx, keptPos, candidates, itemClass, element, distances, 
+      itemClassSet);
+    filterTreeNode(blockIdx, m_treeRight[nodeIdx], oldClassIdx, keptPos, candidates, itemClass, element, distances, 
+      itemClassSet);
+  } else {
+    // leaf: check each item against classes left
+    m_treeClass[nodeIdx] = KMEANS_TREE_MIXED;
+    for(uint j=0; j != classCnt; j++)
+      distances[j] = HUGE_VAL;
+    for(uint p=beginPos; p != endPos; p++)
+    {
+      itemIdx = m_treeIndex[p];
+      loadItem(itemIdx, element);
+      for(uint c=keptPos, epos = keptPos + keptCount; c != epos; c++)
+      {
+        classIdx = candidates[c];
+        distances[classIdx] = calcKMeansDistance(element, &m_classAvg[static_cast<size_t>(classIdx) * m_dimCount], 
+          &m_classScale[0], m_dimCount);
+      }
+      classIdx = selectBestClass(itemIdx, element, distances, itemClassSet);
+      if (classIdx != ((oldClassIdx != KMEANS_TREE_MIXED) ? oldClassIdx : itemClass[itemIdx]))
+        stats.changedCount++;
+      itemClass[itemIdx] = classIdx;
+
+      sumPtr = &blockSums[static_cast<size_t>(classIdx) * m_dimCount];
+      for(uint k=0; k != m_dimCount; k++)
+        sumPtr[k] += element[k];
+      blockCounts[classIdx]++;
+    }
+    stats.distanceCount += static_cast<uint64>(endPos - beginPos) * keptCount;
+    stats.skippedCount += static_cast<uint64>(endPos - beginPos) * (classCnt - keptCount);
+  }
+
+  candidates.resize(keptPos);
+}
+
+// Number of items of node which had class other than classIdx in previous step.
+// Only nodes visited in previous step are walked, so cost is not higher than
+// cost of previous step for this node.
+template < class T >
+uint scDenseKMeans<T>::countTreeChanges(uint nodeIdx, uint oldClassIdx, uint classIdx, const uint *itemClass) const
+{
+  const uint beginPos = m_treeBegin[nodeIdx];
+  const uint endPos = m_treeEnd[nodeIdx];
+  uint res = 0;
+
+  if (oldClassIdx != KMEANS_TREE_MIXED)
+    return (oldClassIdx != classIdx) ? (endPos - beginPos) : 0;
+
+  if (m_treeRight[nodeIdx])
+    return
+      countTreeChanges(nodeIdx + 1, m_treeClass[nodeIdx + 1], classIdx, itemClass) +
+      countTreeChanges(m_treeRight[nodeIdx], m_treeClass[m_treeRight[nodeIdx]], classIdx, itemClass);
+
+  for(uint p=beginPos; p != endPos; p++)
+    if (itemClass[m_treeIndex[p]] != classIdx)
+      res++;
+  return res;
+}
+
+// write classes of nodes assigned as a whole in last step, items of other leaves are already set
+template < class T >
+void scDenseKMeans<T>::assignTreeNode(uint nodeIdx, uint *itemClass) const
+{
+  const uint classIdx = m_treeClass[nodeIdx];
+
+  if (classIdx != KMEANS_TREE_MIXED) {
+    for(uint p=m_treeBegin[nodeIdx], epos = m_treeEnd[nodeIdx]; p != epos; p++)
+      itemClass[m_treeIndex[p]] = classIdx;
+  } else if (m_treeRight[nodeIdx]) {
+    assignTreeNode(nodeIdx + 1, itemClass);
+    assignTreeNode(m_treeRight[nodeIdx], itemClass);
+  }
+}
+
+template < class T >
+uint scDenseKMeans<T>::updateAvg()
+{
+  uint res = 0;
+  const size_t sumsSize = m_classAvg.size();
+  const double *sumPtr;
+  const uint *countPtr;
+  double *avgPtr;
+  double newValue, move, maxMove;
+  const uint partCount = static_cast<uint>(m_blockCounts.size() / m_realClassCount);
+  uint count;
+  bool classChanged;
+
+  // merge partial sums in block (or tree frontier) order
+  for(uint b=1; b < partCount; b++)
+  {
+    sumPtr = &m_blockSums[sumsSize * b];
+    for(size_t p=0; p != sumsSize; p++)
+      m_blockSums[p] += sumPtr[p];
+    for(uint j=0; j != m_realClassCount; j++)
+      m_blockCounts[j] += m_blockCounts[static_cast<size_t>(m_realClassCount) * b + j];
+  }
+
+  if (m_incrementalUpdate && (m_accelMode != kam_kdtree)) {
+    // block sums contain full sums in first step, then changes only
+    if (!m_sumsValid) {
+      m_classSums.assign(m_blockSums.begin(), m_blockSums.begin() + sumsSize);
+      m_classCounts.assign(m_blockCounts.begin(), m_blockCounts.begin() + m_realClassCount);
+      m_sumsValid = true;
+    } else {
+      for(size_t p=0; p != sumsSize; p++)
+        m_classSums[p] += m_blockSums[p];
+      for(uint j=0; j != m_realClassCount; j++)
+        m_classCounts[j] += m_blockCounts[j];
+    }
+    sumPtr = &m_classSums[0];
+    countPtr = &m_classCounts[0];
+  } else {
+    sumPtr = &m_blockSums[0];
+    countPtr = &m_blockCounts[0];
+  }
+
+  // calc avg
+  for(uint j=0; j != m_realClassCount; j++, sumPtr += m_dimCount)
+  {
+    classChanged = false;
+    maxMove = 0.0;
+    count = countPtr[j];
+    avgPtr = &m_classAvg[static_cast<size_t>(j) * m_dimCount];
+
+    for(uint k=0; k != m_dimCount; k++)
+    {
+      if (count > 0)
+        newValue = sumPtr[k] / static_cast<double>(count);
+      else
+        newValue = 0.0;
+
+      if (avgPtr[k] != newValue)
+      {
+        // move relative to class space of current step
+        move = fpAbs(newValue - avgPtr[k]) * m_classScale[k];
+        if (move > maxMove)
+          maxMove = move;
+        avgPtr[k] = newValue;
+        classChanged = true;
+      }
+    } // for k
+
+    if (classChanged && ((m_tolerance <= 0.0) || (maxMove > m_tolerance)))
+      res++;
+  } // for j
+
+  return res;
+}
+
+// ----------------------------------------------------------------------------
+// Explicit instantiation
+// ----------------------------------------------------------------------------
+template class scDenseKMeans<double>;
+template class scDenseKMeans<float>;
+template class scDenseKMeans<signed char>;
@@ -0,0 +1,359 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_io.cpp
+// Project:     scLib
+// Purpose:     File access for clustering input.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#include <stdexcept>
+
+// boost
+#include "boost/iostreams/device/mapped_file.hpp"
+#include "boost/filesystem/operations.hpp"
+
+//sc
+#include "sc/alg/kmeans_io.h"
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scMappedFileReader
+// ----------------------------------------------------------------------------
+scMappedFileReader::scMappedFileReader()
+{
+  m_fileSize = 0;
+  m_windowSize = KMEANS_DEF_MAP_WINDOW_SIZE;
+  m_mappedOffset = 0;
+  m_mappedSize = 0;
+}
+
+scMappedFileReader::~scMappedFileReader()
+{
+  close();
+}
+
+void scMappedFileReader::setWindowSize(uint64 value)
+{
+  m_windowSize = value;
+}
+
+void scMappedFileReader::open(const dtpString &fileName)
+{
+  close();
+  m_fileName = fileName;
+  m_fileSize = boost::filesystem::file_size(fileName);
+  m_file.reset(new boost::iostreams::mapped_file_source());
+}
+
+void scMappedFileReader::close()
+{
+  if (m_file.get() && m_file->is_open())
+    m_file->close();
+  m_file.reset();
+  m_mappedOffset = m_mappedSize = 0;
+}
+
+bool scMappedFileReader::isOpen() const
+{
+  return (m_file.get() != NULL);
+}
+
+uint64 scMappedFileReader::getFileSize() const
+{
+  return m_fileSize;
+}
+
+const char *scMappedFileReader::map(uint64 offset, uint64 size)
+{
+  if (!size)
+    return NULL;
+
+  if ((offset < m_mappedOffset) || (offset + size > m_mappedOffset + m_mappedSize) || !m_file->is_open())
+    mapWindow(offset, size);
+
+  return m_file->data() + (offset - m_mappedOffset);
+}
+
+void scMappedFileReader::mapWindow(uint64 offset, uint64 size)
+{
+  const uint64 alignment = boost::iostreams::mapped_file_source::alignment();
+  boost::iostreams::mapped_file_params params(m_fileName);
+
+  if (m_file->is_open())
+    m_file->close();
+
+  m_mappedOffset = (offset / alignment) * alignment;
+  m_mappedSize = std::min<uint64>(m_fileSize - m_mappedOffset,
+    std::max<uint64>(m_windowSize, offset - m_mappedOffset + size));
+
+  params.offset = static_cast<boost::iostreams::stream_offset>(m_mappedOffset);
+  params.length = static_cast<size_t>(m_mappedSize);
+  m_file->open(params);
+}
+
+// ----------------------------------------------------------------------------
+// Functions
+// ----------------------------------------------------------------------------
+static const char KMEANS_MATRIX_MAGIC[4] = {'S', 'C', 'K', 'M'};
+
+uint getKMeansValueSize(scKMeansValueType valueType)
+{
+  return (valueType == kvt_float) ? sizeof(float) : sizeof(double);
+}
+
+template < class T >
+static void putHeaderField(char *buffer, uint offset, T value)
+{
+  memcpy(buffer + offset, &value, sizeof(T));
+}
+
+template < class T >
+static T getHeaderField(const char *buffer, uint offset)
+{
+  T res;
+  memcpy(&res, buffer + offset, sizeof(T));
+  return res;
+}
+
+void readKMeansMatrixHeader(const dtpString &fileName, scKMeansMatrixHeader &output)
+{
+  char buffer[KMEANS_MATRIX_HEADER_SIZE];
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+
+  if (!file)
+    throw std::runtime_error("Cannot open matrix file: " + fileName);
+
+  file.read(buffer, KMEANS_MATRIX_HEADER_SIZE);
+  if (file.gcount() != KMEANS_MATRIX_HEADER_SIZE)
+    throw std::runtime_error("Matrix file too short: " + fileName);
+
+  if (memcmp(buffer, KMEANS_MATRIX_MAGIC, sizeof(KMEANS_MATRIX_MAGIC)) != 0)
+    throw std::runtime_error("Not a matrix file: " + fileName);
+  if (getHeaderField<uint>(buffer, 4) != KMEANS_MATRIX_BYTE_ORDER_MARK)
+    throw std::runtime_error("Unsupported byte order of matrix file: " + fileName);
+  if (getHeaderField<uint>(buffer, 8) != KMEANS_MATRIX_VERSION)
+    throw std::runtime_error("Unsupported version of matrix file: " + fileName);
+
+  uint valueType = getHeaderField<uint>(buffer, 12);
+  if ((valueType != kvt_float) && (valueType != kvt_double))
+    throw std::runtime_error("Unsupported value type in matrix file: " + fileName);
+
+  output.valueType = static_cast<scKMeansValueType>(valueType);
+  output.dimCount = getHeaderField<uint>(buffer, 16);
+  output.itemCount = getHeaderField<uint64>(buffer, 24);
+  output.dataOffset = getHeaderField<uint64>(buffer, 32);
+
+  if (output.dataOffset < KMEANS_MATRIX_HEADER_SIZE)
+    throw std::runtime_error("Wrong data offset in matrix file: " + fileName);
+  if (output.itemCount && !output.dimCount)
+    throw std::runtime_error("Wrong dim count in matrix file: " + fileName);
+
+  // data is used in place as array of values, mapped window starts at page boundary
+  const uint64 valueSize = getKMeansValueSize(output.valueType);
+  if (output.dataOffset % valueSize != 0)
+    throw std::runtime_error("Misaligned data in matrix file: " + fileName);
+
+  // end of data (offset + item count x dim count x value size) must fit in uint64
+  if (output.dimCount && 
+      (output.itemCount > (~static_cast<uint64>(0) - output.dataOffset) / valueSize / output.dimCount))
+    throw std::runtime_error("Wrong item count in matrix file: " + fileName);
+}
+
+// ----------------------------------------------------------------------------
+// scKMeansMatrixWriter
+// ----------------------------------------------------------------------------
+scKMeansMatrixWriter::scKMeansMatrixWriter()
+{
+  m_header.valueType = kvt_double;
+  m_header.dimCount = 0;
+  m_header.itemCount = 0;
+  m_header.dataOffset = KMEANS_MATRIX_HEADER_SIZE;
+}
+
+scKMeansMatrixWriter::~scKMeansMatrixWriter()
+{
+  try {
+    close();
+  } catch(...) {
+  }
+}
+
+void scKMeansMatrixWriter::open(const dtpString &fileName, uint dimCount, scKMeansValueType valueType)
+{
+  close();
+
+  m_fileName = fileName;
+  m_header.valueType = valueType;
+  m_header.dimCount = dimCount;
+  m_header.itemCount = 0;
+  m_header.dataOffset = KMEANS_MATRIX_HEADER_SIZE;
+
+  m_file.clear();
+  m_file.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file)
+    throw std::runtime_error("Cannot create matrix file: " + fileName);
+
+  writeHeader();
+}
+
+void scKMeansMatrixWriter::writeItems(const double *values, uint itemCount)
+{
+  writeValues(values, static_cast<size_t>(itemCount) * m_header.dimCount);
+  m_header.itemCount += itemCount;
+}
+
+void scKMeansMatrixWriter::writeItems(const float *values, uint itemCount)
+{
+  writeValues(values, static_cast<size_t>(itemCount) * m_header.dimCount);
+  m_header.itemCount += itemCount;
+}
+
+void scKMeansMatrixWriter::close()
+{
+  if (!m_file.is_open())
+    return;
+
+  m_file.seekp(0);
+  writeHeader();
+  m_file.close();
+  if (m_file.fail())
+    throw std::runtime_error("Cannot write matrix file: " + m_fileName);
+}
+
+uint64 scKMeansMatrixWriter::getItemCount() const
+{
+  return m_header.itemCount;
+}
+
+template < class T >
+void scKMeansMatrixWriter::writeValues(const T *values, size_t valueCount)
+{
+  checkState();
+  if (m_header.valueType == kvt_float)
+    writeConverted<T, float>(values, valueCount);
+  else
+    writeConverted<T, double>(values, valueCount);
+  checkState();
+}
+
+template < class T, class FileType >
+void scKMeansMatrixWriter::writeConverted(const T *values, size_t valueCount)
+{
+  FileType buffer[KMEANS_MATRIX_WRITE_BUFFER_SIZE];
+  size_t partSize;
+
+  while (valueCount > 0)
+  {
+    partSize = std::min<size_t>(valueCount, KMEANS_MATRIX_WRITE_BUFFER_SIZE);
+    for(size_t i=0; i != partSize; i++)
+      buffer[i] = static_cast<FileType>(values[i]);
+    m_file.write(reinterpret_cast<const char *>(buffer), partSize * sizeof(FileType));
+    values += partSize;
+    valueCount -= partSize;
+  }
+}
+
+void scKMeansMatrixWriter::writeHeader()
+{
+  char buffer[KMEANS_MATRIX_HEADER_SIZE];
+
+  memset(buffer, 0, sizeof(buffer));
+  memcpy(buffer, KMEANS_MATRIX_MAGIC, sizeof(KMEANS_MATRIX_MAGIC));
+  putHeaderField<uint>(buffer, 4, KMEANS_MATRIX_BYTE_ORDER_MARK);
+  putHeaderField<uint>(buffer, 8, KMEANS_MATRIX_VERSION);
+  putHeaderField<uint>(buffer, 12, static_cast<uint>(m_header.valueType));
+  putHeaderField<uint>(buffer, 16, m_header.dimCount);
+  putHeaderField<uint64>(buffer, 24, m_header.itemCount);
+  putHeaderField<uint64>(buffer, 32, m_header.dataOffset);
+
+  m_file.write(buffer, sizeof(buffer));
+  checkState();
+}
+
+void scKMeansMatrixWriter::checkState()
+{
+  if (!m_file.is_open() || m_file.fail())
+    throw std::runtime_error("Cannot write matrix file: " + m_fileName);
+}
+
+// ----------------------------------------------------------------------------
+// scKMeansMatrixReader
+// ----------------------------------------------------------------------------
+scKMeansMatrixReader::scKMeansMatrixReader()
+{
+  m_header.valueType = kvt_double;
+  m_header.dimCount = 0;
+  m_header.itemCount = 0;
+  m_header.dataOffset = KMEANS_MATRIX_HEADER_SIZE;
+  m_data = NULL;
+}
+
+void scKMeansMatrixReader::open(const dtpString &fileName)
+{
+  close();
+  readKMeansMatrixHeader(fileName, m_header);
+
+  const uint64 dataSize = m_header.itemCount * m_header.dimCount * getKMeansValueSize(m_header.valueType);
+
+  if (dataSize != static_cast<size_t>(dataSize))
+    throw std::runtime_error("Matrix file too large to map: " + fileName);
+
+  m_file.open(fileName);
+  if (m_file.getFileSize() < m_header.dataOffset + dataSize) {
+    m_file.close();
+    throw std::runtime_error("Matrix file is truncated: " + fileName);
+  }
+
+  // whole data in a single window
+  m_file.setWindowSize(dataSize);
+  m_data = m_file.map(m_header.dataOffset, dataSize);
+}
+
+void scKMeansMatrixReader::close()
+{
+  m_file.close();
+  m_data = NULL;
+  m_header.dimCount = 0;
+  m_header.itemCount = 0;
+}
+
+const scKMeansMatrixHeader &scKMeansMatrixReader::getHeader() const
+{
+  return m_header;
+}
+
+uint scKMeansMatrixReader::getDimCount() const
+{
+  return m_header.dimCount;
+}
+
+uint64 scKMeansMatrixReader::getItemCount() const
+{
+  return m_header.itemCount;
+}
+
+scKMeansValueType scKMeansMatrixReader::getValueType() const
+{
+  return m_header.valueType;
+}
+
+const double *scKMeansMatrixReader::getDoubleItems() const
+{
+  if (m_header.valueType != kvt_double)
+    return NULL;
+  return reinterpret_cast<const double *>(m_data);
+}
+
+const float *scKMeansMatrixReader::getFloatItems() const
+{
+  if (m_header.valueType != kvt_float)
+    return NULL;
+  return reinterpret_cast<const float *>(m_data);
+}
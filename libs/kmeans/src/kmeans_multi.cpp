@@ -0,0 +1,197 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_multi.cpp
+// Project:     scLib
+// Purpose:     k-means with several independent restarts.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+//base
+#include "base/rand.h"
+
+//sc
+#include "sc/alg/kmeans_multi.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scMultiStartKMeans
+// ----------------------------------------------------------------------------
+template < class T >
+scMultiStartKMeans<T>::scMultiStartKMeans()
+{
+  m_restartCount = KMEANS_DEF_RESTART_COUNT;
+  m_threadCount = 0;
+  m_seed = 0;
+  m_seedEnabled = false;
+  m_randomSource = NULL;
+  m_input = NULL;
+  m_reader = NULL;
+  m_bestRun = 0;
+  m_realClassCount = 0;
+}
+
+template < class T >
+scDenseKMeans<T> &scMultiStartKMeans<T>::getEngine()
+{
+  return m_engine;
+}
+
+template < class T >
+void scMultiStartKMeans<T>::setRestartCount(uint value)
+{
+  m_restartCount = value;
+}
+
+template < class T >
+void scMultiStartKMeans<T>::setThreadCount(uint value)
+{
+  m_threadCount = value;
+}
+
+template < class T >
+void scMultiStartKMeans<T>::setSeed(uint64 value)
+{
+  m_seed = value;
+  m_seedEnabled = true;
+}
+
+template < class T >
+void scMultiStartKMeans<T>::setRandomGenerator(scRandomGenerator *value)
+{
+  m_randomSource = value;
+}
+
+template < class T >
+uint scMultiStartKMeans<T>::getBestRun() const
+{
+  return m_bestRun;
+}
+
+template < class T >
+double scMultiStartKMeans<T>::getBestInertia() const
+{
+  if (m_runInertia.empty())
+    return 0.0;
+  return m_runInertia[m_bestRun];
+}
+
+template < class T >
+const std::vector<double> &scMultiStartKMeans<T>::getRunInertia() const
+{
+  return m_runInertia;
+}
+
+template < class T >
+const std::vector<uint> &scMultiStartKMeans<T>::getRunStepCount() const
+{
+  return m_runStepCount;
+}
+
+template < class T >
+const std::vector<double> &scMultiStartKMeans<T>::getClassAvg() const
+{
+  return m_classAvg;
+}
+
+template < class T >
+uint scMultiStartKMeans<T>::execute(const T *input, uint itemCount, uint dimCount, uint *itemClass)
+{
+  m_input = input;
+  m_reader = NULL;
+  return run(itemCount, dimCount, itemClass);
+}
+
+template < class T >
+uint scMultiStartKMeans<T>::execute(const scKMeansItemReader &input, uint itemCount, uint dimCount, uint *itemClass)
+{
+  m_input = NULL;
+  m_reader = &input;
+  return run(itemCount, dimCount, itemClass);
+}
+
+// each worker keeps one class buffer, best result is copied to output
+template < class T >
+uint scMultiStartKMeans<T>::run(uint itemCount, uint dimCount, uint *itemClass)
+{
+  const int runCount = static_cast<int>(std::max<uint>(m_restartCount, 1));
+  const uint workerCount = std::min<uint>(getWorkerCount(), static_cast<uint>(runCount));
+  const uint64 baseSeed = m_seedEnabled ? m_seed :
+    (m_randomSource ? m_randomSource->next() : randomHash(randomUInt64()));
+  bool bestFound = false;
+
+  m_bestRun = 0;
+  m_realClassCount = 0;
+  m_classAvg.clear();
+  m_runInertia.assign(runCount, 0.0);
+  m_runStepCount.assign(runCount, 0);
+
+  if (!itemCount || !dimCount)
+    return 0;
+
+#pragma omp parallel num_threads(workerCount) if(workerCount > 1)
+  {
+    std::vector<uint> runClass(itemCount);
+    scDenseKMeans<T> engine;
+    uint classCount;
+    double inertia;
+
+#pragma omp for schedule(dynamic)
+    for(int r = 0; r < runCount; r++)
+    {
+      engine = m_engine;
+      engine.setSeed(randomHash(baseSeed + static_cast<uint64>(r)));
+      if (workerCount > 1)
+        engine.setThreadCount(1);
+
+      if (m_reader)
+        classCount = engine.execute(*m_reader, itemCount, dimCount, &runClass[0]);
+      else
+        classCount = engine.execute(m_input, itemCount, dimCount, &runClass[0]);
+      inertia = engine.calcInertia(&runClass[0]);
+
+      m_runInertia[r] = inertia;
+      m_runStepCount[r] = engine.getStepCount();
+
+#pragma omp critical(kmeans_multi_best)
+      {
+        if (!bestFound || (inertia < m_runInertia[m_bestRun]) ||
+           ((inertia == m_runInertia[m_bestRun]) && (static_cast<uint>(r) < m_bestRun)))
+        {
+          bestFound = true;
+          m_bestRun = static_cast<uint>(r);
+          m_realClassCount = classCount;
+          m_classAvg = engine.getClassAvg();
+          std::copy(runClass.begin(), runClass.end(), itemClass);
+        }
+      }
+    }
+  }
+
+  return m_realClassCount;
+}
+
+template < class T >
+uint scMultiStartKMeans<T>::getWorkerCount() const
+{
+#ifdef _OPENMP
+  if (!m_threadCount)
+    return omp_get_max_threads();
+#endif
+  return m_threadCount ? m_threadCount : 1;
+}
+
+// ----------------------------------------------------------------------------
+// Explicit instantiation
+// ----------------------------------------------------------------------------
+template class scMultiStartKMeans<double>;
+template class scMultiStartKMeans<float>;
@@ -0,0 +1,284 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_quant.cpp
+// Project:     scLib
+// Purpose:     Quantized (8-bit) storage of k-means input.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <algorithm>
+
+//sc
+#include "sc/utils.h"
+#include "sc/alg/kmeans_quant.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scKMeansQuantizedMatrix
+// ----------------------------------------------------------------------------
+scKMeansQuantizedMatrix::scKMeansQuantizedMatrix()
+{
+  m_itemCount = 0;
+  m_dimCount = 0;
+}
+
+void scKMeansQuantizedMatrix::quantize(const double *input, uint itemCount, uint dimCount)
+{
+  quantizeValues<double>(input, itemCount, dimCount);
+}
+
+void scKMeansQuantizedMatrix::quantize(const float *input, uint itemCount, uint dimCount)
+{
+  quantizeValues<float>(input, itemCount, dimCount);
+}
+
+void scKMeansQuantizedMatrix::clear()
+{
+  m_itemCount = m_dimCount = 0;
+  m_data.clear();
+  m_scale.clear();
+  m_offset.clear();
+}
+
+// offset = middle of range, scale = half of range / max code
+template < class T >
+void scKMeansQuantizedMatrix::quantizeValues(const T *input, uint itemCount, uint dimCount)
+{
+  std::vector<double> dimMin(dimCount, HUGE_VAL), dimMax(dimCount, -HUGE_VAL);
+  const T *row;
+  signed char *codePtr;
+  double value, code;
+
+  m_itemCount = itemCount;
+  m_dimCount = dimCount;
+
+  for(uint i=0; i != itemCount; i++)
+  {
+    row = input + static_cast<size_t>(i) * dimCount;
+    for(uint k=0; k != dimCount; k++)
+    {
+      value = static_cast<double>(row[k]);
+      if (value - value != 0.0)
+        continue;
+      if (value < dimMin[k])
+        dimMin[k] = value;
+      if (value > dimMax[k])
+        dimMax[k] = value;
+    }
+  }
+
+  m_scale.resize(dimCount);
+  m_offset.resize(dimCount);
+  for(uint k=0; k != dimCount; k++)
+  {
+    if (dimMin[k] > dimMax[k]) {
+      // no finite values
+      m_offset[k] = 0.0;
+      m_scale[k] = 1.0;
+    } else {
+      m_offset[k] = 0.5 * (dimMin[k] + dimMax[k]);
+      m_scale[k] = 0.5 * (dimMax[k] - dimMin[k]) / KMEANS_QUANT_MAX_CODE;
+      if (m_scale[k] <= 0.0)
+        m_scale[k] = 1.0;
+    }
+  }
+
+  m_data.resize(static_cast<size_t>(itemCount) * dimCount);
+  for(uint i=0; i != itemCount; i++)
+  {
+    row = input + static_cast<size_t>(i) * dimCount;
+    codePtr = &m_data[static_cast<size_t>(i) * dimCount];
+    for(uint k=0; k != dimCount; k++)
+    {
+      value = static_cast<double>(row[k]);
+      if (value - value != 0.0)
+        code = 0.0;
+      else
+        code = std::floor((value - m_offset[k]) / m_scale[k] + 0.5);
+      code = std::max<double>(-KMEANS_QUANT_MAX_CODE, std::min<double>(KMEANS_QUANT_MAX_CODE, code));
+      codePtr[k] = static_cast<signed char>(code);
+    }
+  }
+}
+
+void scKMeansQuantizedMatrix::readItem(uint itemIdx, double *output) const
+{
+  const signed char *codePtr = &m_data[static_cast<size_t>(itemIdx) * m_dimCount];
+  for(uint k=0; k != m_dimCount; k++)
+    output[k] = static_cast<double>(codePtr[k]) * m_scale[k] + m_offset[k];
+}
+
+const signed char *scKMeansQuantizedMatrix::getData() const
+{
+  return m_data.empty() ? NULL : &m_data[0];
+}
+
+uint scKMeansQuantizedMatrix::getItemCount() const
+{
+  return m_itemCount;
+}
+
+uint scKMeansQuantizedMatrix::getDimCount() const
+{
+  return m_dimCount;
+}
+
+const std::vector<double> &scKMeansQuantizedMatrix::getScale() const
+{
+  return m_scale;
+}
+
+const std::vector<double> &scKMeansQuantizedMatrix::getOffset() const
+{
+  return m_offset;
+}
+
+// ----------------------------------------------------------------------------
+// Storage comparison
+// ----------------------------------------------------------------------------
+static double getKMeansWallTime()
+{
+#ifdef _OPENMP
+  return omp_get_wtime();
+#else
+  return cpu_timef();
+#endif
+}
+
+// one assignment pass for fixed class averages, lowest class on equal distance
+template < class T >
+static void assignKMeansStorage(const T *input, uint itemCount, uint dimCount, const std::vector<double> &inputScale,
+  const std::vector<double> &inputOffset, const std::vector<double> &classAvg, uint threadCount, uint *itemClass)
+{
+  const uint classCount = static_cast<uint>(classAvg.size() / dimCount);
+  const int blockCount = static_cast<int>((itemCount + KMEANS_MIN_BLOCK_SIZE - 1) / KMEANS_MIN_BLOCK_SIZE);
+  std::vector<double> classSpace, classScale;
+
+#ifdef _OPENMP
+  if (!threadCount)
+    threadCount = omp_get_max_threads();
+#endif
+  if (!threadCount)
+    threadCount = 1;
+
+  calcKMeansClassScale(&classAvg[0], classCount, dimCount, classSpace, classScale);
+
+#pragma omp parallel for schedule(dynamic) num_threads(threadCount) if(blockCount > 1)
+  for(int b = 0; b < blockCount; b++)
+  {
+    const uint beginPos = static_cast<uint>(b) * KMEANS_MIN_BLOCK_SIZE;
+    const uint endPos = std::min<uint>(itemCount, beginPos + KMEANS_MIN_BLOCK_SIZE);
+    std::vector<double> element(dimCount);
+    const T *row;
+    double distance, bestDist;
+    uint bestClassIdx;
+
+    for(uint i=beginPos; i != endPos; i++)
+    {
+      row = input + static_cast<size_t>(i) * dimCount;
+      for(uint k=0; k != dimCount; k++)
+        if (inputScale.empty())
+          element[k] = static_cast<double>(row[k]);
+        else
+          element[k] = static_cast<double>(row[k]) * inputScale[k] + inputOffset[k];
+
+      bestClassIdx = 0;
+      bestDist = HUGE_VAL;
+      for(uint j=0; j != classCount; j++)
+      {
+        distance = calcKMeansDistance(&element[0], &classAvg[static_cast<size_t>(j) * dimCount],
+          &classScale[0], dimCount);
+        if (distance < bestDist) {
+          bestDist = distance;
+          bestClassIdx = j;
+        }
+      }
+      itemClass[i] = bestClassIdx;
+    }
+  }
+}
+
+template < class T >
+static void runKMeansStorage(const T *input, uint itemCount, uint dimCount, const std::vector<double> &inputScale,
+  const std::vector<double> &inputOffset, uint classCount, uint stepLimit, uint threadCount, uint64 seed,
+  const std::vector<double> &refClassAvg, const std::vector<uint> &refRunClass, const std::vector<uint> &refAssignClass,
+  std::vector<double> &classAvg, std::vector<uint> &runClass, std::vector<uint> &assignClass,
+  scKMeansStorageStats &stats)
+{
+  scDenseKMeans<T> engine;
+  double startTime;
+  uint runSame = 0, assignSame = 0;
+
+  engine.setClassCount(classCount);
+  engine.setStepLimit(stepLimit);
+  engine.setThreadCount(threadCount);
+  engine.setSeed(seed);
+  engine.setInputScale(inputScale, inputOffset);
+
+  runClass.resize(itemCount);
+  startTime = getKMeansWallTime();
+  engine.execute(input, itemCount, dimCount, &runClass[0]);
+  stats.runTime = getKMeansWallTime() - startTime;
+
+  stats.valueSize = sizeof(T);
+  stats.stepCount = engine.getStepCount();
+  stats.itemRate = (stats.runTime > 0.0) ?
+    static_cast<double>(itemCount) * stats.stepCount / stats.runTime : 0.0;
+  classAvg = engine.getClassAvg();
+
+  // double input is the reference itself
+  assignClass.resize(itemCount);
+  assignKMeansStorage<T>(input, itemCount, dimCount, inputScale, inputOffset,
+    refClassAvg.empty() ? classAvg : refClassAvg, threadCount, &assignClass[0]);
+
+  for(uint i=0; i != itemCount; i++)
+  {
+    if (refRunClass.empty() || (runClass[i] == refRunClass[i]))
+      runSame++;
+    if (refAssignClass.empty() || (assignClass[i] == refAssignClass[i]))
+      assignSame++;
+  }
+  stats.runAgreement = static_cast<double>(runSame) / itemCount;
+  stats.assignAgreement = static_cast<double>(assignSame) / itemCount;
+}
+
+void compareKMeansStorage(const double *input, uint itemCount, uint dimCount, uint classCount, uint stepLimit,
+  uint threadCount, uint64 seed, std::vector<scKMeansStorageStats> &stats)
+{
+  const std::vector<double> noScale;
+  const std::vector<double> noAvg;
+  const std::vector<uint> noClass;
+  std::vector<double> refClassAvg, classAvg;
+  std::vector<uint> refRunClass, refAssignClass, runClass, assignClass;
+
+  stats.resize(kst_quantized + 1);
+  if (!itemCount || !dimCount)
+    return;
+
+  runKMeansStorage<double>(input, itemCount, dimCount, noScale, noScale, classCount, stepLimit, threadCount, seed,
+    noAvg, noClass, noClass, refClassAvg, refRunClass, refAssignClass, stats[kst_double]);
+
+  {
+    std::vector<float> floatInput(input, input + static_cast<size_t>(itemCount) * dimCount);
+    runKMeansStorage<float>(&floatInput[0], itemCount, dimCount, noScale, noScale, classCount, stepLimit,
+      threadCount, seed, refClassAvg, refRunClass, refAssignClass, classAvg, runClass, assignClass,
+      stats[kst_float]);
+  }
+
+  {
+    scKMeansQuantizedMatrix quantInput;
+    quantInput.quantize(input, itemCount, dimCount);
+    runKMeansStorage<signed char>(quantInput.getData(), itemCount, dimCount, quantInput.getScale(),
+      quantInput.getOffset(), classCount, stepLimit, threadCount, seed, refClassAvg, refRunClass, refAssignClass,
+      classAvg, runClass, assignClass, stats[kst_quantized]);
+  }
+}
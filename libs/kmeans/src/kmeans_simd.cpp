@@ -0,0 +1,267 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_simd.cpp
+// Project:     scLib
+// Purpose:     Vectorized distance kernels for k-means.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+// a*b+c must not be fused, otherwise kernels would differ from scalar code
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#include "sc/alg/kmeans_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KMEANS_SIMD_X86
+#endif
+
+#ifdef KMEANS_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+#if defined(__GNUC__)
+#define KMEANS_TARGET(a) __attribute__((target(a)))
+#else
+#define KMEANS_TARGET(a)
+#endif
+
+// ----------------------------------------------------------------------------
+// Scalar
+// ----------------------------------------------------------------------------
+double calcKMeansDistance(const double *item, const double *classAvg, const double *classScale, uint dimCount)
+{
+  double res = 0.0;
+  double diff;
+  for(uint k=0; k != dimCount; k++)
+  {
+    diff = (item[k] - classAvg[k]) * classScale[k];
+    res += diff * diff;
+  }
+  return res;
+}
+
+double calcKMeansExactDistance(const double *item, const double *classAvg, const double *classSpace, uint dimCount)
+{
+  double res = 0.0;
+  double diff;
+  for(uint k=0; k != dimCount; k++)
+  {
+    diff = (item[k] - classAvg[k]) / classSpace[k];
+    res += diff * diff;
+  }
+  return res;
+}
+
+static void calcDistancesScalar(const double *item, const double *classAvgT, const double *classScale,
+  uint dimCount, uint classStride, double *output)
+{
+  const double *avgRow;
+  double diff;
+
+  for(uint j=0; j != classStride; j++)
+    output[j] = 0.0;
+
+  for(uint k=0; k != dimCount; k++)
+  {
+    avgRow = classAvgT + static_cast<size_t>(k) * classStride;
+    for(uint j=0; j != classStride; j++)
+    {
+      diff = (item[k] - avgRow[j]) * classScale[k];
+      output[j] += diff * diff;
+    }
+  }
+}
+
+#ifdef KMEANS_SIMD_X86
+// ----------------------------------------------------------------------------
+// SSE2 - 4 vectors x 2 classes
+// ----------------------------------------------------------------------------
+KMEANS_TARGET("sse2")
+static void calcDistancesSse2(const double *item, const double *classAvgT, const double *classScale,
+  uint dimCount, uint classStride, double *output)
+{
+  __m128d acc0, acc1, acc2, acc3, x, s, d0, d1, d2, d3;
+  const double *avgPtr;
+
+  for(uint j=0; j < classStride; j += 8)
+  {
+    acc0 = acc1 = acc2 = acc3 = _mm_setzero_pd();
+    avgPtr = classAvgT + j;
+    for(uint k=0; k != dimCount; k++, avgPtr += classStride)
+    {
+      x = _mm_set1_pd(item[k]);
+      s = _mm_set1_pd(classScale[k]);
+      d0 = _mm_mul_pd(_mm_sub_pd(x, _mm_loadu_pd(avgPtr)), s);
+      d1 = _mm_mul_pd(_mm_sub_pd(x, _mm_loadu_pd(avgPtr + 2)), s);
+      d2 = _mm_mul_pd(_mm_sub_pd(x, _mm_loadu_pd(avgPtr + 4)), s);
+      d3 = _mm_mul_pd(_mm_sub_pd(x, _mm_loadu_pd(avgPtr + 6)), s);
+      acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+      acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+      acc2 = _mm_add_pd(acc2, _mm_mul_pd(d2, d2));
+      acc3 = _mm_add_pd(acc3, _mm_mul_pd(d3, d3));
+    }
+    _mm_storeu_pd(output + j, acc0);
+    _mm_storeu_pd(output + j + 2, acc1);
+    _mm_storeu_pd(output + j + 4, acc2);
+    _mm_storeu_pd(output + j + 6, acc3);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// AVX2 - 2 vectors x 4 classes
+// ----------------------------------------------------------------------------
+KMEANS_TARGET("avx2")
+static void calcDistancesAvx2(const double *item, const double *classAvgT, const double *classScale,
+  uint dimCount, uint classStride, double *output)
+{
+  __m256d acc0, acc1, x, s, d0, d1;
+  const double *avgPtr;
+
+  for(uint j=0; j < classStride; j += 8)
+  {
+    acc0 = acc1 = _mm256_setzero_pd();
+    avgPtr = classAvgT + j;
+    for(uint k=0; k != dimCount; k++, avgPtr += classStride)
+    {
+      x = _mm256_set1_pd(item[k]);
+      s = _mm256_set1_pd(classScale[k]);
+      d0 = _mm256_mul_pd(_mm256_sub_pd(x, _mm256_loadu_pd(avgPtr)), s);
+      d1 = _mm256_mul_pd(_mm256_sub_pd(x, _mm256_loadu_pd(avgPtr + 4)), s);
+      acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(d0, d0));
+      acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(d1, d1));
+    }
+    _mm256_storeu_pd(output + j, acc0);
+    _mm256_storeu_pd(output + j + 4, acc1);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// AVX-512 - 1 vector x 8 classes
+// ----------------------------------------------------------------------------
+KMEANS_TARGET("avx512f")
+static void calcDistancesAvx512(const double *item, const double *classAvgT, const double *classScale,
+  uint dimCount, uint classStride, double *output)
+{
+  __m512d acc, x, s, d;
+  const double *avgPtr;
+
+  for(uint j=0; j < classStride; j += 8)
+  {
+    acc = _mm512_setzero_pd();
+    avgPtr = classAvgT + j;
+    for(uint k=0; k != dimCount; k++, avgPtr += classStride)
+    {
+      x = _mm512_set1_pd(item[k]);
+      s = _mm512_set1_pd(classScale[k]);
+      d = _mm512_mul_pd(_mm512_sub_pd(x, _mm512_loadu_pd(avgPtr)), s);
+      acc = _mm512_add_pd(acc, _mm512_mul_pd(d, d));
+    }
+    _mm512_storeu_pd(output + j, acc);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// CPU detection
+// ----------------------------------------------------------------------------
+#if defined(_MSC_VER)
+static bool isOsSavingYmm(uint64 mask)
+{
+  return ((_xgetbv(0) & mask) == mask);
+}
+#endif
+
+static scKMeansSimdLevel detectCpuLevel()
+{
+#if defined(__GNUC__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return ksl_avx512;
+  if (__builtin_cpu_supports("avx2"))
+    return ksl_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return ksl_sse2;
+  return ksl_scalar;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  int maxLeaf = info[0];
+  __cpuid(info, 1);
+  bool hasSse2 = (info[3] & (1 << 26)) != 0;
+  bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+  if (maxLeaf >= 7 && hasOsxsave) {
+    __cpuidex(info, 7, 0);
+    // XMM, YMM, opmask, ZMM state
+    if (((info[1] & (1 << 16)) != 0) && isOsSavingYmm(0xE6))
+      return ksl_avx512;
+    if (((info[1] & (1 << 5)) != 0) && isOsSavingYmm(0x06))
+      return ksl_avx2;
+  }
+  return hasSse2 ? ksl_sse2 : ksl_scalar;
+#else
+  return ksl_scalar;
+#endif
+}
+#endif // KMEANS_SIMD_X86
+
+// ----------------------------------------------------------------------------
+// Dispatch
+// ----------------------------------------------------------------------------
+scKMeansSimdLevel detectKMeansSimdLevel()
+{
+#ifdef KMEANS_SIMD_X86
+  static scKMeansSimdLevel level = detectCpuLevel();
+  return level;
+#else
+  return ksl_scalar;
+#endif
+}
+
+scKMeansSimdLevel resolveKMeansSimdLevel(scKMeansSimdLevel level)
+{
+  scKMeansSimdLevel supported = detectKMeansSimdLevel();
+  if ((level == ksl_auto) || (level > supported))
+    return supported;
+  return level;
+}
+
+scKMeansDistanceKernel getKMeansDistanceKernel(scKMeansSimdLevel level)
+{
+  switch (resolveKMeansSimdLevel(level)) {
+#ifdef KMEANS_SIMD_X86
+    case ksl_avx512:
+      return calcDistancesAvx512;
+    case ksl_avx2:
+      return calcDistancesAvx2;
+    case ksl_sse2:
+      return calcDistancesSse2;
+#endif
+    default:
+      return calcDistancesScalar;
+  }
+}
+
+uint calcKMeansClassStride(uint classCount)
+{
+  return ((classCount + KMEANS_SIMD_CLASS_ALIGN - 1) / KMEANS_SIMD_CLASS_ALIGN) * KMEANS_SIMD_CLASS_ALIGN;
+}
+
+void transposeKMeansClassAvg(const double *classAvg, uint classCount, uint dimCount, std::vector<double> &output)
+{
+  const uint classStride = calcKMeansClassStride(classCount);
+
+  // padding classes stay zero, their distances are ignored
+  output.assign(static_cast<size_t>(classStride) * dimCount, 0.0);
+  for(uint j=0; j != classCount; j++)
+    for(uint k=0; k != dimCount; k++)
+      output[static_cast<size_t>(k) * classStride + j] = classAvg[static_cast<size_t>(j) * dimCount + k];
+}
@@ -0,0 +1,398 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_stream.cpp
+// Project:     scLib
+// Purpose:     Mini-batch k-means for input read in chunks.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+//base
+#include "base/rand.h"
+
+//sc
+#include "sc/alg/kmeans_stream.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scKMeansMappedFileSource
+// ----------------------------------------------------------------------------
+template < class T >
+scKMeansMappedFileSource<T>::scKMeansMappedFileSource(const dtpString &fileName, uint dimCount, uint64 dataOffset)
+{
+  m_dimCount = dimCount;
+  m_dataOffset = dataOffset;
+  m_itemNo = 0;
+  m_reader.open(fileName);
+
+  const uint64 fileSize = m_reader.getFileSize();
+  if (!dimCount || (fileSize <= dataOffset))
+    m_itemCount = 0;
+  else
+    m_itemCount = (fileSize - dataOffset) / (sizeof(T) * static_cast<uint64>(dimCount));
+}
+
+template < class T >
+void scKMeansMappedFileSource<T>::setWindowSize(uint64 value)
+{
+  m_reader.setWindowSize(value);
+}
+
+template < class T >
+uint64 scKMeansMappedFileSource<T>::getItemCount() const
+{
+  return m_itemCount;
+}
+
+template < class T >
+uint scKMeansMappedFileSource<T>::getDimCount() const
+{
+  return m_dimCount;
+}
+
+template < class T >
+uint scKMeansMappedFileSource<T>::readChunk(double *output, uint maxItemCount)
+{
+  const uint itemCount = static_cast<uint>(std::min<uint64>(maxItemCount, m_itemCount - m_itemNo));
+  if (!itemCount)
+    return 0;
+
+  const uint64 itemSize = sizeof(T) * static_cast<uint64>(m_dimCount);
+  const size_t valueCount = static_cast<size_t>(itemCount) * m_dimCount;
+  const char *data = m_reader.map(m_dataOffset + m_itemNo * itemSize, itemCount * itemSize);
+  T value;
+
+  // values are copied byte-wise, file offset does not have to be aligned for T
+  for(size_t i=0; i != valueCount; i++)
+  {
+    std::copy(data, data + sizeof(T), reinterpret_cast<char *>(&value));
+    data += sizeof(T);
+    output[i] = static_cast<double>(value);
+  }
+
+  m_itemNo += itemCount;
+  return itemCount;
+}
+
+template < class T >
+void scKMeansMappedFileSource<T>::rewind()
+{
+  m_itemNo = 0;
+}
+
+template class scKMeansMappedFileSource<double>;
+template class scKMeansMappedFileSource<float>;
+
+// ----------------------------------------------------------------------------
+// scKMeansMatrixFileSource
+// ----------------------------------------------------------------------------
+scKMeansMatrixFileSource::scKMeansMatrixFileSource(const dtpString &fileName)
+{
+  m_itemNo = 0;
+  readKMeansMatrixHeader(fileName, m_header);
+  if (m_header.valueType == kvt_float)
+    m_source.reset(new scKMeansMappedFileSource<float>(fileName, m_header.dimCount, m_header.dataOffset));
+  else
+    m_source.reset(new scKMeansMappedFileSource<double>(fileName, m_header.dimCount, m_header.dataOffset));
+}
+
+const scKMeansMatrixHeader &scKMeansMatrixFileSource::getHeader() const
+{
+  return m_header;
+}
+
+uint scKMeansMatrixFileSource::getDimCount() const
+{
+  return m_header.dimCount;
+}
+
+// number of items is taken from header, not from file size
+uint scKMeansMatrixFileSource::readChunk(double *output, uint maxItemCount)
+{
+  const uint itemCount = static_cast<uint>(std::min<uint64>(maxItemCount, m_header.itemCount - m_itemNo));
+  if (!itemCount)
+    return 0;
+
+  const uint res = m_source->readChunk(output, itemCount);
+  m_itemNo += res;
+  return res;
+}
+
+void scKMeansMatrixFileSource::rewind()
+{
+  m_source->rewind();
+  m_itemNo = 0;
+}
+
+// ----------------------------------------------------------------------------
+// scStreamKMeans
+// ----------------------------------------------------------------------------
+scStreamKMeans::scStreamKMeans()
+{
+  m_classCount = KMEANS_DEF_CLASS_COUNT;
+  m_batchSize = KMEANS_DEF_BATCH_SIZE;
+  m_epochCount = KMEANS_DEF_EPOCH_COUNT;
+  m_threadCount = 1;
+  m_seed = 0;
+  m_simdLevel = ksl_auto;
+  m_initMode = kim_plus_plus;
+  m_transform = NULL;
+  m_dimCount = 0;
+  m_realClassCount = 0;
+  m_batchCount = 0;
+  m_distanceKernel = NULL;
+  m_classStride = 0;
+}
+
+void scStreamKMeans::setClassCount(uint value)
+{
+  m_classCount = value;
+}
+
+void scStreamKMeans::setBatchSize(uint value)
+{
+  m_batchSize = value;
+}
+
+void scStreamKMeans::setEpochCount(uint value)
+{
+  m_epochCount = value;
+}
+
+void scStreamKMeans::setThreadCount(uint value)
+{
+  m_threadCount = value;
+}
+
+void scStreamKMeans::setSeed(uint64 value)
+{
+  m_seed = value;
+}
+
+void scStreamKMeans::setSimdLevel(scKMeansSimdLevel value)
+{
+  m_simdLevel = value;
+}
+
+void scStreamKMeans::setInitMode(scKMeansInitMode value)
+{
+  m_initMode = value;
+}
+
+void scStreamKMeans::setTransform(const scKMeansFeatureTransform *value)
+{
+  m_transform = value;
+}
+
+const std::vector<double> &scStreamKMeans::getClassAvg() const
+{
+  return m_classAvg;
+}
+
+const std::vector<uint64> &scStreamKMeans::getClassItemCount() const
+{
+  return m_classItemCount;
+}
+
+uint64 scStreamKMeans::getBatchCount() const
+{
+  return m_batchCount;
+}
+
+uint scStreamKMeans::execute(scKMeansChunkSource &source, scKMeansClassSink &output)
+{
+  uint res = train(source);
+  if (res)
+    assign(source, output);
+  return res;
+}
+
+uint scStreamKMeans::train(scKMeansChunkSource &source)
+{
+  const uint epochCount = std::max<uint>(m_epochCount, 1);
+  uint itemCount;
+
+  m_dimCount = source.getDimCount();
+  m_realClassCount = 0;
+  m_batchCount = 0;
+  m_classAvg.clear();
+  m_classItemCount.clear();
+
+  if (!m_dimCount || !m_batchSize)
+    return 0;
+
+  m_batch.resize(static_cast<size_t>(m_batchSize) * m_dimCount);
+  m_batchClass.resize(m_batchSize);
+  m_distanceKernel = getKMeansDistanceKernel(m_simdLevel);
+
+  for(uint epochNo = 0; epochNo != epochCount; epochNo++)
+  {
+    source.rewind();
+    while ((itemCount = readBatch(source)) > 0)
+    {
+      if (!m_realClassCount) {
+        initAvg(itemCount);
+      } else {
+        prepareDistance();
+        assignBatch(itemCount, m_batchCount);
+        updateAvg(itemCount);
+      }
+      m_batchCount++;
+    }
+
+    if (!m_realClassCount)
+      break;
+  }
+
+  return m_realClassCount;
+}
+
+void scStreamKMeans::assign(scKMeansChunkSource &source, scKMeansClassSink &output)
+{
+  uint itemCount;
+
+  if (!m_realClassCount)
+    return;
+
+  m_batch.resize(static_cast<size_t>(m_batchSize) * m_dimCount);
+  m_batchClass.resize(m_batchSize);
+  if (!m_distanceKernel)
+    m_distanceKernel = getKMeansDistanceKernel(m_simdLevel);
+  prepareDistance();
+
+  // batch numbers used for tie-breaks continue after training
+  uint64 batchNo = m_batchCount;
+  source.rewind();
+  while ((itemCount = readBatch(source)) > 0)
+  {
+    assignBatch(itemCount, batchNo++);
+    output.putClasses(&m_batchClass[0], itemCount);
+  }
+}
+
+uint scStreamKMeans::readBatch(scKMeansChunkSource &source)
+{
+  uint res = source.readChunk(&m_batch[0], m_batchSize);
+  if (m_transform)
+    for(uint i=0; i != res; i++)
+      m_transform->apply(&m_batch[static_cast<size_t>(i) * m_dimCount], m_dimCount);
+  return res;
+}
+
+// initial averages: full k-means on first batch
+// items of this batch are counted as already used by their classes
+void scStreamKMeans::initAvg(uint itemCount)
+{
+  scDenseKMeans<double> engine;
+
+  engine.setClassCount(m_classCount);
+  engine.setStepLimit(KMEANS_DEF_STEP_LIMIT);
+  engine.setThreadCount(m_threadCount);
+  engine.setSeed(m_seed);
+  engine.setSimdLevel(m_simdLevel);
+  engine.setInitMode(m_initMode);
+
+  m_realClassCount = engine.execute(&m_batch[0], itemCount, m_dimCount, &m_batchClass[0]);
+  m_classAvg = engine.getClassAvg();
+  m_classItemCount.assign(m_realClassCount, 0);
+  for(uint i=0; i != itemCount; i++)
+    m_classItemCount[m_batchClass[i]]++;
+}
+
+void scStreamKMeans::prepareDistance()
+{
+  calcKMeansClassScale(&m_classAvg[0], m_realClassCount, m_dimCount, m_classSpace, m_classScale);
+  transposeKMeansClassAvg(&m_classAvg[0], m_realClassCount, m_dimCount, m_classAvgT);
+  m_classStride = calcKMeansClassStride(m_realClassCount);
+}
+
+// assign nearest class to each item of batch, averages are not modified
+void scStreamKMeans::assignBatch(uint itemCount, uint64 batchNo)
+{
+  const int blockCount = static_cast<int>((itemCount + KMEANS_STREAM_BLOCK_SIZE - 1) / KMEANS_STREAM_BLOCK_SIZE);
+  const uint64 batchKey = randomHash(m_seed ^ batchNo);
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(blockCount > 1)
+  for(int b = 0; b < blockCount; b++)
+  {
+    const uint beginPos = static_cast<uint>(b) * KMEANS_STREAM_BLOCK_SIZE;
+    const uint endPos = std::min<uint>(itemCount, beginPos + KMEANS_STREAM_BLOCK_SIZE);
+    std::vector<double> distances(m_classStride);
+
+    for(uint i=beginPos; i != endPos; i++)
+      m_batchClass[i] = findClass(i, batchKey, &distances[0]);
+  }
+}
+
+// move averages towards assigned items, learning rate 1 / number of items used by class
+void scStreamKMeans::updateAvg(uint itemCount)
+{
+  const double *element;
+  double *avgPtr;
+  double rate;
+  uint classIdx;
+
+  for(uint i=0; i != itemCount; i++)
+  {
+    classIdx = m_batchClass[i];
+    element = &m_batch[static_cast<size_t>(i) * m_dimCount];
+    avgPtr = &m_classAvg[static_cast<size_t>(classIdx) * m_dimCount];
+    m_classItemCount[classIdx]++;
+    rate = 1.0 / static_cast<double>(m_classItemCount[classIdx]);
+    for(uint k=0; k != m_dimCount; k++)
+      avgPtr[k] += rate * (element[k] - avgPtr[k]);
+  }
+}
+
+uint scStreamKMeans::findClass(uint itemIdx, uint64 batchKey, double *distances) const
+{
+  uint bestClassIdx = 0;
+  uint tieCount = 1;
+
+  m_distanceKernel(&m_batch[static_cast<size_t>(itemIdx) * m_dimCount], &m_classAvgT[0], &m_classScale[0],
+    m_dimCount, m_classStride, distances);
+
+  for(uint j=1; j < m_realClassCount; j++)
+  {
+    if (distances[j] < distances[bestClassIdx]) {
+      bestClassIdx = j;
+      tieCount = 1;
+    } else if (distances[j] == distances[bestClassIdx]) {
+      tieCount++;
+    }
+  }
+
+  if (tieCount > 1) {
+    // select one of equal classes in ascending order
+    uint tieIdx = static_cast<uint>(randomHash(batchKey + itemIdx) % tieCount);
+    const double bestDist = distances[bestClassIdx];
+    for(uint j=bestClassIdx; j < m_realClassCount; j++)
+      if (distances[j] == bestDist) {
+        if (!tieIdx) {
+          bestClassIdx = j;
+          break;
+        }
+        tieIdx--;
+      }
+  }
+
+  return bestClassIdx;
+}
+
+uint scStreamKMeans::getWorkerCount() const
+{
+#ifdef _OPENMP
+  if (!m_threadCount)
+    return omp_get_max_threads();
+#endif
+  return m_threadCount ? m_threadCount : 1;
+}
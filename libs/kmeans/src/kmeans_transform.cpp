@@ -0,0 +1,106 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        kmeans_transform.cpp
+// Project:     scLib
+// Purpose:     Feature transforms applied to k-means input when it is read.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+//base
+#include "base/bmath.h"
+
+//sc
+#include "sc/utils.h"
+#include "sc/alg/kmeans_transform.h"
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scKMeansIdentityTransform
+// ----------------------------------------------------------------------------
+void scKMeansIdentityTransform::apply(double * /*values*/, uint /*dimCount*/) const
+{
+}
+
+// ----------------------------------------------------------------------------
+// scKMeansLog10Transform
+// ----------------------------------------------------------------------------
+void scKMeansLog10Transform::apply(double *values, uint dimCount) const
+{
+  for(uint k=0; k != dimCount; k++)
+    values[k] = fpSign<double>(values[k]) * log10(fpAbs<double>(values[k]));
+}
+
+// ----------------------------------------------------------------------------
+// scKMeansZScoreTransform
+// ----------------------------------------------------------------------------
+scKMeansZScoreTransform::scKMeansZScoreTransform()
+{
+  m_itemCount = 0;
+}
+
+void scKMeansZScoreTransform::setStats(const std::vector<double> &mean, const std::vector<double> &stdDev)
+{
+  m_mean = mean;
+  m_stdDev = stdDev;
+  prepareScale();
+}
+
+const std::vector<double> &scKMeansZScoreTransform::getMean() const
+{
+  return m_mean;
+}
+
+const std::vector<double> &scKMeansZScoreTransform::getStdDev() const
+{
+  return m_stdDev;
+}
+
+void scKMeansZScoreTransform::resetStats(uint dimCount)
+{
+  m_itemCount = 0;
+  m_mean.assign(dimCount, 0.0);
+  m_sumSq.assign(dimCount, 0.0);
+  m_stdDev.clear();
+  m_scale.clear();
+}
+
+void scKMeansZScoreTransform::addItem(const double *values)
+{
+  double delta;
+
+  m_itemCount++;
+  for(uint k=0, epos = m_mean.size(); k != epos; k++)
+  {
+    delta = values[k] - m_mean[k];
+    m_mean[k] += delta / static_cast<double>(m_itemCount);
+    m_sumSq[k] += delta * (values[k] - m_mean[k]);
+  }
+}
+
+// population deviation
+void scKMeansZScoreTransform::finishStats()
+{
+  m_stdDev.resize(m_mean.size());
+  for(uint k=0, epos = m_mean.size(); k != epos; k++)
+    m_stdDev[k] = m_itemCount ? std::sqrt(m_sumSq[k] / static_cast<double>(m_itemCount)) : 0.0;
+  prepareScale();
+}
+
+void scKMeansZScoreTransform::prepareScale()
+{
+  m_scale.resize(m_stdDev.size());
+  for(uint k=0, epos = m_stdDev.size(); k != epos; k++)
+    m_scale[k] = (m_stdDev[k] > 0.0) ? 1.0 / m_stdDev[k] : 1.0;
+}
+
+void scKMeansZScoreTransform::apply(double *values, uint dimCount) const
+{
+  for(uint k=0; k != dimCount; k++)
+    values[k] = (values[k] - m_mean[k]) * m_scale[k];
+}
@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoCheckpoint.h
+// Project:     scLib
+// Purpose:     Binary checkpoint of PSO swarm state
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSOCHECKPOINT_H__
+#define _PSOCHECKPOINT_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoCheckpoint.h
+///
+/// Snapshot of complete scPsoSwarm state, so long optimization can be
+/// continued after restart. Restored swarm continues exactly as original one
+/// in pum_block mode, in pum_legacy mode when random generator is given with
+/// setRandomGenerator() (global generator state is not saved).
+///
+/// Checkpoint file format (native byte order):
+///   offset  size  contents
+///        0     4  magic "SCPS"
+///        4     4  byte order mark 0x01020304
+///        8     4  format version (1)
+///       12     4  flags (see pcf_ values)
+///       16     4  particle count
+///       20     4  param count
+///       24     4  history length
+///       28     4  update mode
+///       32     4  step number
+///       36     4  topology type
+///       40     8  factor1 (double)
+///       48     8  factor2 (double)
+///       56     8  inertia factor (double)
+///       64     8  seed
+///       72     8  run seed
+///       80    32  random generator state (pcf_random_state)
+///      112     4  topology neighbour count
+///      116     4  topology refresh interval
+///      120     8  topology run seed
+///      128     -  sections
+/// Section: id (4), value size (4), value count (8), values padded to 8 bytes.
+/// Sections are written one after another, unknown sections are skipped by
+/// reader. Arrays of particle values are stored param by param, as in swarm.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//boost
+#include "boost/thread/thread.hpp"
+
+//base
+#include "base/btypes.h"
+#include "base/string.h"
+
+//sc
+#include "sc/alg/PsoSwarm.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+enum scPsoCheckpointFlag {
+  pcf_velocity_valid = 1,
+  pcf_best_valid = 2,
+  pcf_seed_enabled = 4,
+  pcf_random_state = 8,
+  pcf_history = 16
+};
+
+enum scPsoCheckpointSection {
+  pcs_param_min = 1,
+  pcs_param_max,
+  pcs_param_int,
+  pcs_position,
+  pcs_velocity,
+  pcs_best_position,
+  pcs_score,
+  pcs_best_score,
+  pcs_particle_step,
+  pcs_history_position,
+  pcs_history_score,
+  pcs_history_queue,
+  pcs_queue_begin,
+  pcs_queue_size,
+  pcs_best_step
+};
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint PSO_CHECKPOINT_VERSION = 1;
+const uint PSO_CHECKPOINT_HEADER_SIZE = 128;
+const uint PSO_CHECKPOINT_SECTION_HEADER_SIZE = 16;
+const uint PSO_CHECKPOINT_BYTE_ORDER_MARK = 0x01020304;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Writer of checkpoint files. In writeAsync() swarm is copied to memory
+/// image (memcpy of arrays) and file is written by background thread, so
+/// optimization continues during write. File is written under temporary
+/// name and renamed when complete, so previous checkpoint survives failure.
+/// Writer is used directly on swarm, e.g. scPsoOptimizer::getSwarm().
+/// Error of write still pending at destruction is printed to stderr.
+class scPsoCheckpointWriter {
+public:
+  // -- create
+  scPsoCheckpointWriter();
+  ~scPsoCheckpointWriter();
+  // -- run
+  void write(const scPsoSwarm &swarm, const dtpString &fileName);
+  /// Returns when swarm is copied, waits for previous write before.
+  /// Swarm must not be updated during call.
+  void writeAsync(const scPsoSwarm &swarm, const dtpString &fileName);
+  /// wait for background write, throws std::runtime_error if it failed
+  void wait();
+protected:
+  void prepareImage(const scPsoSwarm &swarm);
+  void writeHeader(const scPsoSwarm &swarm);
+  template < class T >
+  void writeSection(scPsoCheckpointSection sectionId, const std::vector<T> &values);
+  void writeFile();
+private:
+  scPsoCheckpointWriter(const scPsoCheckpointWriter &);
+  scPsoCheckpointWriter &operator=(const scPsoCheckpointWriter &);
+protected:
+  std::vector<char> m_image;
+  dtpString m_fileName;
+  dtpString m_error;
+  boost::thread m_thread;
+};
+
+/// Reader of checkpoint files. File is memory-mapped and copied to swarm.
+class scPsoCheckpointReader {
+public:
+  /// Restore swarm from file, throws std::runtime_error on error.
+  /// Thread count and random generator of swarm are kept, state of random
+  /// generator is restored if it was saved.
+  void read(const dtpString &fileName, scPsoSwarm &swarm);
+protected:
+  void readHeader(const char *data, uint64 size, scPsoSwarm &swarm);
+  template < class T >
+  bool readSection(const char *sectionPtr, uint valueSize, uint64 valueCount, std::vector<T> &output);
+protected:
+  dtpString m_fileName;
+  uint m_flags;
+  uint m_sectionMask;
+};
+
+#endif // _PSOCHECKPOINT_H__
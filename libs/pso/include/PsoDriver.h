@@ -0,0 +1,102 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoDriver.h
+// Project:     scLib
+// Purpose:     PSO loop with parallel fitness evaluation
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSODRIVER_H__
+#define _PSODRIVER_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoDriver.h
+///
+/// Optimization loop for scPsoSwarm: particles are evaluated by fitness
+/// function object on OpenMP threads and swarm is updated with results.
+///
+/// In pdm_sync mode all particles of generation are evaluated, then whole
+/// swarm is updated (scPsoSwarm::step()).
+/// In pdm_async mode each particle is updated (scPsoSwarm::stepParticle())
+/// as soon as its own score is ready and goes back to evaluation, so threads
+/// do not wait for slowest particle of generation. Order of updates depends
+/// on timing, so results are not repeatable.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+
+//sc
+#include "sc/alg/PsoSwarm.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+enum scPsoDriverMode {
+  pdm_sync,   ///< whole generation evaluated, then swarm updated (default)
+  pdm_async   ///< particle updated when its score is ready
+};
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint PSO_DEF_STEP_LIMIT = 100;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Fitness of particle, higher is better.
+/// Called from many threads at once, so it must be thread-safe.
+class scPsoFitnessFunction {
+public:
+  virtual ~scPsoFitnessFunction() {}
+  /// score for paramCount values of particle
+  virtual double calcFitness(const double *values, uint paramCount) const = 0;
+};
+
+class scPsoDriver {
+public:
+  // -- create
+  scPsoDriver();
+  // -- properties
+  void setMode(scPsoDriverMode value);
+  /// number of threads evaluating fitness, 0 = OpenMP default (default)
+  void setThreadCount(uint value);
+  /// number of generations, in pdm_async mode: evaluations = stepLimit x particle count
+  void setStepLimit(uint value);
+  // -- run
+  /// Optimize starting from current positions of swarm. Ranges and
+  /// factors of swarm must be set before.
+  void execute(scPsoSwarm &swarm, const scPsoFitnessFunction &fitness);
+  // -- results
+  /// best score evaluated during execute()
+  double getBestScore() const;
+  /// values of particle with best score
+  const std::vector<double> &getBestValues() const;
+  uint getEvalCount() const;
+protected:
+  void runSync(scPsoSwarm &swarm, const scPsoFitnessFunction &fitness);
+  void runAsync(scPsoSwarm &swarm, const scPsoFitnessFunction &fitness);
+  void updateBest(double score, const double *values, uint paramCount);
+  uint getWorkerCount() const;
+protected:
+  // config
+  scPsoDriverMode m_mode;
+  uint m_threadCount;
+  uint m_stepLimit;
+  // results
+  double m_bestScore;
+  std::vector<double> m_bestValues;
+  uint m_evalCount;
+};
+
+#endif // _PSODRIVER_H__
@@ -0,0 +1,138 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoFitnessCache.h
+// Project:     scLib
+// Purpose:     Cache and surrogate model for expensive PSO fitness
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSOFITNESSCACHE_H__
+#define _PSOFITNESSCACHE_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoFitnessCache.h
+///
+/// Fitness function which wraps expensive one and calls it only when needed:
+/// - exact cache: position is quantized (value / quantum, rounded) and score
+///   of already evaluated key is returned. Int params are evaluated on
+///   integer positions, so revisits hit cache with default exact keys.
+/// - surrogate (optional): score is predicted from k nearest evaluated
+///   positions (inverse distance weights). When prediction is worse than
+///   given quantile of evaluated scores, position is not evaluated and
+///   screened score (-HUGE_VAL by default) is returned, so it never becomes
+///   best position of particle. Only promising positions reach real evaluator.
+///
+/// Can be used with scPsoDriver and scPsoIslandModel from many threads.
+/// Lookups and predictions run in parallel under shared lock, only storing
+/// of evaluation is exclusive. Evaluator is called outside of lock, so the
+/// same new position evaluated at once by two threads is evaluated twice.
+/// Number of stored evaluations is limited (setCapacity()), which also
+/// limits cost of prediction.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//boost
+#include "boost/unordered_map.hpp"
+#include "boost/thread/shared_mutex.hpp"
+
+//base
+#include "base/btypes.h"
+
+//sc
+#include "sc/alg/PsoDriver.h"
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint PSO_DEF_SURROGATE_MIN_SAMPLES = 20;
+const double PSO_DEF_SURROGATE_QUANTILE = 0.5;
+const uint PSO_MAX_SURROGATE_NEIGHBOURS = 32;
+const uint PSO_DEF_CACHE_CAPACITY = 100000;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+class scPsoCachedFitness: public scPsoFitnessFunction {
+public:
+  // -- create
+  /// evaluator is not owned
+  scPsoCachedFitness(const scPsoFitnessFunction &evaluator, uint paramCount);
+  // -- properties
+  /// positions closer than quantum on param share one cache entry, 0 = exact value (default)
+  void setQuantum(uint paramIdx, double value);
+  /// max number of stored evaluations (default PSO_DEF_CACHE_CAPACITY), 0 = no limit,
+  /// when full new evaluations are not stored
+  void setCapacity(uint value);
+  /// Enable surrogate with neighbourCount nearest evaluations (at most
+  /// PSO_MAX_SURROGATE_NEIGHBOURS), used after minSampleCount evaluations.
+  /// Positions with predicted score below screenQuantile (0..1) of
+  /// evaluated scores are not evaluated.
+  void setSurrogate(uint neighbourCount, uint minSampleCount = PSO_DEF_SURROGATE_MIN_SAMPLES,
+    double screenQuantile = PSO_DEF_SURROGATE_QUANTILE);
+  /// score returned for position screened by surrogate, -HUGE_VAL by default
+  void setScreenedScore(double value);
+  /// distance of param in surrogate is multiplied by scale, default 1
+  void setDistanceScale(uint paramIdx, double value);
+  // -- run
+  virtual double calcFitness(const double *values, uint paramCount) const;
+  /// remove cached evaluations and clear statistics
+  void clear();
+  // -- statistics
+  uint getCallCount() const;
+  /// number of calls answered from cache
+  uint getHitCount() const;
+  /// number of calls answered by surrogate
+  uint getScreenedCount() const;
+  /// number of calls of evaluator
+  uint getEvalCount() const;
+  /// hits / calls
+  double getHitRate() const;
+  /// evaluations saved by cache and surrogate
+  uint getSavedCount() const;
+protected:
+  typedef std::vector<int64> scPsoCacheKey;
+  typedef boost::unordered_map<scPsoCacheKey, uint> scPsoCacheMap;
+  void prepareKey(const double *values, scPsoCacheKey &output) const;
+  bool predictScore(const double *values, double &output) const;
+  double getScreenLimit() const;
+  void storeResult(const scPsoCacheKey &key, const double *values, double score) const;
+  void balanceScoreHeaps() const;
+private:
+  scPsoCachedFitness(const scPsoCachedFitness &);
+  scPsoCachedFitness &operator=(const scPsoCachedFitness &);
+protected:
+  // config
+  const scPsoFitnessFunction &m_evaluator;
+  uint m_paramCount;
+  std::vector<double> m_quantum;
+  std::vector<double> m_distanceScale;
+  uint m_capacity;
+  uint m_neighbourCount;
+  uint m_minSampleCount;
+  double m_screenQuantile;
+  double m_screenedScore;
+  // state: evaluated positions (row-major) and scores, index of sample for key
+  mutable boost::shared_mutex m_mutex;
+  mutable scPsoCacheMap m_index;
+  mutable std::vector<double> m_sampleValues;
+  mutable std::vector<double> m_sampleScore;
+  // evaluated scores split at screen quantile: max-heap of lower ones
+  // (screen limit on top) and min-heap of the rest
+  mutable std::vector<double> m_lowScore;
+  mutable std::vector<double> m_highScore;
+  // statistics
+  mutable uint m_callCount;
+  mutable uint m_hitCount;
+  mutable uint m_screenedCount;
+  mutable uint m_evalCount;
+};
+
+#endif // _PSOFITNESSCACHE_H__
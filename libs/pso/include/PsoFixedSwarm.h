@@ -0,0 +1,363 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoFixedSwarm.h
+// Project:     scLib
+// Purpose:     PSO swarm specialised for fixed number of params
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSOFIXEDSWARM_H__
+#define _PSOFIXEDSWARM_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoFixedSwarm.h
+///
+/// PSO swarm for small problems solved many times (inner tuning loops).
+/// Number of params and their schema (type and range of each param) are
+/// template arguments, so loops over params have constant length and
+/// int / double choice and limits are constants - compiler can unroll and
+/// vectorize update of particle. Values of particle are stored together
+/// (ParamCount doubles per particle).
+///
+/// Schema is a class with static functions, which should be inline:
+///   static bool isInt(uint paramIdx);
+///   static double getMin(uint paramIdx);
+///   static double getMax(uint paramIdx);
+/// scPsoRangeSchema can be used when all params have the same integer range.
+///
+/// Update is the same as in scPsoSwarm without history: limits are applied
+/// without branches and random values come from own stream (see setSeed),
+/// generated for whole swarm at once. Implementation is in header, because
+/// schema is defined by user.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+//base
+#include "base/btypes.h"
+#include "base/rand.h"
+
+//sc
+#include "sc/alg/PsoSwarm.h"
+#include "sc/alg/PsoTopology.h"
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// All params in range MinValue..MaxValue, int params if IsInt
+template < int MinValue, int MaxValue, bool IsInt = false >
+class scPsoRangeSchema {
+public:
+  static bool isInt(uint) { return IsInt; }
+  static double getMin(uint) { return MinValue; }
+  static double getMax(uint) { return MaxValue; }
+};
+
+template < uint ParamCount, class Schema >
+class scPsoFixedSwarm {
+public:
+  // -- create
+  scPsoFixedSwarm();
+  // -- properties
+  /// allocate state for given number of particles, clears velocity and bests
+  void resize(uint particleCount);
+  uint getParticleCount() const;
+  /// weights of attraction to particle best and to neighbourhood best
+  void setFactors(double factor1, double factor2);
+  /// how much previous velocity is kept, values 0..1
+  void setInertiaFactor(double value);
+  /// seed of random stream, random if not set
+  void setSeed(uint64 value);
+  /// neighbourhood of particles
+  scPsoTopology &getTopology();
+  uint getStepNo() const;
+  // -- state
+  /// ParamCount values of particle
+  double *getPosition(uint particleIdx);
+  const double *getPosition(uint particleIdx) const;
+  const double *getVelocity(uint particleIdx) const;
+  const double *getBestPosition(uint particleIdx) const;
+  /// scores of current positions, to be filled before step()
+  double *getScore();
+  const double *getBestScore() const;
+  // -- run
+  /// update bests with current scores, then velocity and position of all particles
+  void step();
+  /// Evaluate and update swarm stepLimit times. Fitness is object with
+  /// operator()(const double *values) returning score (higher is better),
+  /// it is called directly, so it can be inlined. Returns index of particle
+  /// with best personal best.
+  template < class Fitness >
+  uint run(const Fitness &fitness, uint stepLimit);
+  /// clear velocity and bests, positions are kept
+  void reset();
+protected:
+  static double roundValue(double value);
+  void initVelocity();
+  void updateBest();
+  void updateParticle(uint particleIdx, uint localBestIdx, const double *randomValues);
+protected:
+  // config
+  uint m_particleCount;
+  double m_factor1;
+  double m_factor2;
+  double m_inertiaFactor;
+  uint64 m_seed;
+  bool m_seedEnabled;
+  scPsoTopology m_topology;
+  // state, ParamCount values for each particle
+  uint m_stepNo;
+  bool m_velocityValid;
+  bool m_bestValid;
+  std::vector<double> m_position;
+  std::vector<double> m_velocity;
+  std::vector<double> m_bestPosition;
+  std::vector<double> m_score;
+  std::vector<double> m_bestScore;
+  std::vector<double> m_randomValues;
+  scRandomLaneGenerator m_random;
+};
+
+// ----------------------------------------------------------------------------
+// scPsoFixedSwarm
+// ----------------------------------------------------------------------------
+template < uint ParamCount, class Schema >
+scPsoFixedSwarm<ParamCount, Schema>::scPsoFixedSwarm()
+{
+  m_particleCount = 0;
+  m_factor1 = PSO_DEF_FACTOR1;
+  m_factor2 = PSO_DEF_FACTOR2;
+  m_inertiaFactor = PSO_DEF_INERTIA_FACTOR;
+  m_seed = 0;
+  m_seedEnabled = false;
+  m_stepNo = 0;
+  m_velocityValid = false;
+  m_bestValid = false;
+}
+
+template < uint ParamCount, class Schema >
+void scPsoFixedSwarm<ParamCount, Schema>::resize(uint particleCount)
+{
+  const size_t stateSize = static_cast<size_t>(particleCount) * ParamCount;
+
+  m_particleCount = particleCount;
+  m_position.assign(stateSize, 0.0);
+  m_velocity.assign(stateSize, 0.0);
+  m_bestPosition.assign(stateSize, 0.0);
+  m_score.assign(particleCount, 0.0);
+  m_bestScore.assign(particleCount, 0.0);
+  m_randomValues.resize(3 * stateSize);
+  reset();
+}
+
+template < uint ParamCount, class Schema >
+uint scPsoFixedSwarm<ParamCount, Schema>::getParticleCount() const
+{
+  return m_particleCount;
+}
+
+template < uint ParamCount, class Schema >
+void scPsoFixedSwarm<ParamCount, Schema>::setFactors(double factor1, double factor2)
+{
+  m_factor1 = factor1;
+  m_factor2 = factor2;
+}
+
+template < uint ParamCount, class Schema >
+void scPsoFixedSwarm<ParamCount, Schema>::setInertiaFactor(double value)
+{
+  m_inertiaFactor = value;
+}
+
+template < uint ParamCount, class Schema >
+void scPsoFixedSwarm<ParamCount, Schema>::setSeed(uint64 value)
+{
+  m_seed = value;
+  m_seedEnabled = true;
+}
+
+template < uint ParamCount, class Schema >
+scPsoTopology &scPsoFixedSwarm<ParamCount, Schema>::getTopology()
+{
+  return m_topology;
+}
+
+template < uint ParamCount, class Schema >
+uint scPsoFixedSwarm<ParamCount, Schema>::getStepNo() const
+{
+  return m_stepNo;
+}
+
+template < uint ParamCount, class Schema >
+double *scPsoFixedSwarm<ParamCount, Schema>::getPosition(uint particleIdx)
+{
+  return &m_position[static_cast<size_t>(particleIdx) * ParamCount];
+}
+
+template < uint ParamCount, class Schema >
+const double *scPsoFixedSwarm<ParamCount, Schema>::getPosition(uint particleIdx) const
+{
+  return &m_position[static_cast<size_t>(particleIdx) * ParamCount];
+}
+
+template < uint ParamCount, class Schema >
+const double *scPsoFixedSwarm<ParamCount, Schema>::getVelocity(uint particleIdx) const
+{
+  return &m_velocity[static_cast<size_t>(particleIdx) * ParamCount];
+}
+
+template < uint ParamCount, class Schema >
+const double *scPsoFixedSwarm<ParamCount, Schema>::getBestPosition(uint particleIdx) const
+{
+  return &m_bestPosition[static_cast<size_t>(particleIdx) * ParamCount];
+}
+
+template < uint ParamCount, class Schema >
+double *scPsoFixedSwarm<ParamCount, Schema>::getScore()
+{
+  return m_score.empty() ? NULL : &m_score[0];
+}
+
+template < uint ParamCount, class Schema >
+const double *scPsoFixedSwarm<ParamCount, Schema>::getBestScore() const
+{
+  return m_bestScore.empty() ? NULL : &m_bestScore[0];
+}
+
+template < uint ParamCount, class Schema >
+void scPsoFixedSwarm<ParamCount, Schema>::reset()
+{
+  m_stepNo = 0;
+  m_velocityValid = false;
+  m_bestValid = false;
+}
+
+// round half away from zero, as in scPsoSwarm
+template < uint ParamCount, class Schema >
+inline double scPsoFixedSwarm<ParamCount, Schema>::roundValue(double value)
+{
+  return static_cast<double>(static_cast<int64>(value + ((value < 0.0) ? -0.5 : 0.5)));
+}
+
+// random stream is seeded on first step after reset
+template < uint ParamCount, class Schema >
+void scPsoFixedSwarm<ParamCount, Schema>::initVelocity()
+{
+  double *vel = &m_velocity[0];
+  const double *pos = &m_position[0];
+  double *randomValues = &m_randomValues[0];
+
+  m_random.seed(m_seedEnabled ? m_seed : randomHash(randomUInt64()));
+  m_random.fillDouble(randomValues, m_position.size());
+
+  for(uint i=0; i != m_particleCount; i++, vel += ParamCount, pos += ParamCount, randomValues += ParamCount)
+    for(uint j=0; j != ParamCount; j++)
+    {
+      vel[j] = pos[j] * (0.1 + 0.9 * randomValues[j]);
+      if (Schema::isInt(j))
+        vel[j] = roundValue(vel[j]);
+    }
+
+  m_velocityValid = true;
+}
+
+template < uint ParamCount, class Schema >
+void scPsoFixedSwarm<ParamCount, Schema>::updateBest()
+{
+  for(uint i=0; i != m_particleCount; i++)
+    if (!m_bestValid || (m_score[i] > m_bestScore[i])) {
+      m_bestScore[i] = m_score[i];
+      std::copy(getPosition(i), getPosition(i) + ParamCount, &m_bestPosition[static_cast<size_t>(i) * ParamCount]);
+    }
+  m_bestValid = true;
+}
+
+template < uint ParamCount, class Schema >
+void scPsoFixedSwarm<ParamCount, Schema>::step()
+{
+  if (!m_particleCount)
+    return;
+
+  if (!m_velocityValid)
+    initVelocity();
+
+  updateBest();
+
+  m_topology.prepare(m_particleCount, m_stepNo);
+  m_topology.prepareBest(&m_bestScore[0]);
+  m_random.fillDouble(&m_randomValues[0], m_randomValues.size());
+
+  for(uint i=0; i != m_particleCount; i++)
+    updateParticle(i, m_topology.findBest(i, &m_bestScore[0]), &m_randomValues[static_cast<size_t>(i) * 3 * ParamCount]);
+
+  m_stepNo++;
+}
+
+// Loops have constant length and schema values are constants, so branches
+// on param type disappear. Out of range distance is max(d, 0) = (d + |d|) / 2.
+template < uint ParamCount, class Schema >
+inline void scPsoFixedSwarm<ParamCount, Schema>::updateParticle(uint particleIdx, uint localBestIdx,
+  const double *randomValues)
+{
+  const size_t offset = static_cast<size_t>(particleIdx) * ParamCount;
+  double *pos = &m_position[offset];
+  double *vel = &m_velocity[offset];
+  const double *best = &m_bestPosition[offset];
+  const double *local = &m_bestPosition[static_cast<size_t>(localBestIdx) * ParamCount];
+  const double socialFactor = (localBestIdx != particleIdx) ? m_factor2 : 0.0;
+  double velocity, newPos, lowDist, highDist;
+
+  for(uint j=0; j != ParamCount; j++)
+  {
+    velocity = vel[j]
+      + m_factor1 * randomValues[j] * (best[j] - pos[j])
+      + socialFactor * randomValues[ParamCount + j] * (local[j] - pos[j]);
+    velocity = (m_inertiaFactor * vel[j]) + (1.0 - m_inertiaFactor) * velocity;
+
+    newPos = pos[j] + velocity;
+    if (Schema::isInt(j))
+      newPos = roundValue(newPos);
+
+    lowDist = Schema::getMin(j) - newPos;
+    highDist = newPos - Schema::getMax(j);
+    velocity += (1.0 + 0.5 * randomValues[2 * ParamCount + j])
+      * (0.5 * (lowDist + std::fabs(lowDist)) - 0.5 * (highDist + std::fabs(highDist)));
+
+    vel[j] = velocity;
+    pos[j] = Schema::isInt(j) ? roundValue(pos[j] + velocity) : pos[j] + velocity;
+  }
+}
+
+template < uint ParamCount, class Schema >
+template < class Fitness >
+uint scPsoFixedSwarm<ParamCount, Schema>::run(const Fitness &fitness, uint stepLimit)
+{
+  uint res = 0;
+
+  if (!m_particleCount)
+    return 0;
+
+  for(uint s=0; s != stepLimit; s++)
+  {
+    for(uint i=0; i != m_particleCount; i++)
+      m_score[i] = fitness(getPosition(i));
+    step();
+  }
+
+  for(uint i=1; i != m_particleCount; i++)
+    if (m_bestScore[i] > m_bestScore[res])
+      res = i;
+
+  return res;
+}
+
+#endif // _PSOFIXEDSWARM_H__
@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoIsland.h
+// Project:     scLib
+// Purpose:     Island model: several PSO swarms exchanging best particles
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSOISLAND_H__
+#define _PSOISLAND_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoIsland.h
+///
+/// Island model for PSO: each island is separate swarm optimized by own
+/// scPsoDriver on own thread, so evaluations per second grow with number of
+/// islands. Every migration interval each island sends its best particles
+/// to next island on ring (i+1) through channel (see PsoMigration.h) and
+/// places received particles at positions of its worst particles. Islands
+/// are isolated between migrations, which keeps diversity of search.
+///
+/// Islands of one model can be spread over processes: each process runs
+/// scPsoIslandModel with its local islands, first island index and total
+/// number of islands, all using channel which crosses process boundary.
+///
+/// Each island gets own random generator (split from seed, see
+/// splitRandomStreams()), so islands do not share global generator.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+#include "base/rand.h"
+
+//sc
+#include "sc/alg/PsoSwarm.h"
+#include "sc/alg/PsoDriver.h"
+#include "sc/alg/PsoMigration.h"
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint PSO_DEF_MIGRATION_INTERVAL = 10;
+const uint PSO_DEF_MIGRANT_COUNT = 1;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+class scPsoIslandModel {
+public:
+  // -- create
+  scPsoIslandModel();
+  // -- properties
+  /// number of islands run by this model, swarms of islands are cleared
+  void setIslandCount(uint value);
+  uint getIslandCount() const;
+  /// swarm of local island, ranges, factors and start positions must be set before execute()
+  scPsoSwarm &getIsland(uint islandIdx);
+  const scPsoSwarm &getIsland(uint islandIdx) const;
+  /// global index of first local island and number of islands in all processes
+  /// (0 = local islands only), used as addresses in channel
+  void setGlobalIslands(uint firstIdx, uint totalCount);
+  /// Channel used for migration (not owned). If not set, islands of this
+  /// model use channel in memory.
+  void setChannel(scPsoMigrationChannel *value);
+  /// number of generations between migrations, 0 = no migration
+  void setMigrationInterval(uint value);
+  /// number of best particles sent by island at each migration
+  void setMigrantCount(uint value);
+  /// number of generations of each island
+  void setStepLimit(uint value);
+  /// driver mode used on each island
+  void setMode(scPsoDriverMode value);
+  /// number of islands running at once, 0 = OpenMP default (default)
+  void setThreadCount(uint value);
+  /// seed of island random generators, random if not set
+  void setSeed(uint64 value);
+  // -- run
+  void execute(const scPsoFitnessFunction &fitness);
+  // -- results
+  double getBestScore() const;
+  const std::vector<double> &getBestValues() const;
+  /// global index of island which found best particle
+  uint getBestIsland() const;
+  uint getEvalCount() const;
+  /// number of particles received by local islands
+  uint getReceivedCount() const;
+protected:
+  void runIsland(uint islandIdx, const scPsoFitnessFunction &fitness, scPsoMigrationChannel &channel);
+  void sendMigrants(uint islandIdx, scPsoMigrationChannel &channel);
+  uint receiveMigrants(uint islandIdx, scPsoMigrationChannel &channel);
+  uint getTotalIslandCount() const;
+  uint getWorkerCount() const;
+protected:
+  // config
+  uint m_firstIslandIdx;
+  uint m_totalIslandCount;
+  scPsoMigrationChannel *m_channel;
+  uint m_migrationInterval;
+  uint m_migrantCount;
+  uint m_stepLimit;
+  scPsoDriverMode m_mode;
+  uint m_threadCount;
+  uint64 m_seed;
+  bool m_seedEnabled;
+  // state
+  std::vector<scPsoSwarm> m_islands;
+  std::vector<scRandomGenerator> m_random;
+  std::vector<double> m_islandBestScore;
+  std::vector<std::vector<double> > m_islandBestValues;
+  std::vector<uint> m_islandEvalCount;
+  std::vector<uint> m_islandReceivedCount;
+  // results
+  double m_bestScore;
+  std::vector<double> m_bestValues;
+  uint m_bestIsland;
+  uint m_evalCount;
+  uint m_receivedCount;
+};
+
+#endif // _PSOISLAND_H__
@@ -0,0 +1,96 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoMigration.h
+// Project:     scLib
+// Purpose:     Channels for particles migrating between PSO islands
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSOMIGRATION_H__
+#define _PSOMIGRATION_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoMigration.h
+///
+/// Channels used by island model (see PsoIsland.h) to send best particles
+/// from one swarm to another. Migrant is sent as one message: score and
+/// paramCount values. Islands are identified by global index, so islands of
+/// one model can live in several processes.
+///
+/// Migration is best-effort: send() never waits, migrant is dropped when
+/// queue of target island is full or target is not running yet.
+///
+/// Channels:
+/// - scPsoMemoryChannel: queues in memory, for islands of one process
+/// - scPsoQueueChannel: Boost.Interprocess message queues in shared memory,
+///   for processes on one machine
+/// - scPsoSocketChannel (PsoSocketChannel.h): Unix datagram sockets,
+///   where platform supports them
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+#include <deque>
+
+//boost
+#include "boost/ptr_container/ptr_vector.hpp"
+#include "boost/interprocess/ipc/message_queue.hpp"
+
+//base
+#include "base/btypes.h"
+#include "base/string.h"
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+/// number of migrants waiting for island, above that oldest (memory) or newest (other) are dropped
+const uint PSO_DEF_CHANNEL_CAPACITY = 64;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Must be thread-safe: islands of one process send and receive from own threads.
+class scPsoMigrationChannel {
+public:
+  virtual ~scPsoMigrationChannel() {}
+  /// send particle to island, does not wait
+  virtual void send(uint islandIdx, const double *values, uint paramCount, double score) = 0;
+  /// take one waiting particle of island, returns false if there is none
+  virtual bool receive(uint islandIdx, double *values, uint paramCount, double &score) = 0;
+};
+
+class scPsoMemoryChannel: public scPsoMigrationChannel {
+public:
+  scPsoMemoryChannel(uint islandCount, uint capacity = PSO_DEF_CHANNEL_CAPACITY);
+  virtual void send(uint islandIdx, const double *values, uint paramCount, double score);
+  virtual bool receive(uint islandIdx, double *values, uint paramCount, double &score);
+protected:
+  uint m_capacity;
+  // for each island: score, values, score, values...
+  std::vector<std::deque<double> > m_queue;
+};
+
+/// Queue of each island is named "<name>_<islandIdx>". Queues are created by
+/// first process which opens them, removeQueues() should be called when
+/// all processes are done.
+class scPsoQueueChannel: public scPsoMigrationChannel {
+public:
+  scPsoQueueChannel(const scString &name, uint islandCount, uint paramCount,
+    uint capacity = PSO_DEF_CHANNEL_CAPACITY);
+  virtual void send(uint islandIdx, const double *values, uint paramCount, double score);
+  virtual bool receive(uint islandIdx, double *values, uint paramCount, double &score);
+  static void removeQueues(const scString &name, uint islandCount);
+protected:
+  static scString getQueueName(const scString &name, uint islandIdx);
+protected:
+  uint m_paramCount;
+  boost::ptr_vector<boost::interprocess::message_queue> m_queues;
+};
+
+#endif // _PSOMIGRATION_H__
@@ -16,12 +16,16 @@
 // ----------------------------------------------------------------------------
 /// \file PsoOptimizer.h
 ///
-/// 
+/// PSO optimizer working on scDataNode items. Calculation is performed by
+/// scPsoSwarm (see PsoSwarm.h), item values are copied to its arrays
+/// in each step. Items are identified by position, names are kept.
 
 // ----------------------------------------------------------------------------
 // Headers
 // ----------------------------------------------------------------------------
 #include "sc/dtypes.h"
+#include "sc/alg/PsoSwarm.h"
+#include "sc/alg/PsoDriver.h"
 
 // ----------------------------------------------------------------------------
 // Simple type definitions
@@ -34,9 +38,6 @@
 // ----------------------------------------------------------------------------
 // Constants
 // ----------------------------------------------------------------------------
-const double PSO_DEF_FACTOR1 = 2.0;
-const double PSO_DEF_FACTOR2 = 2.0;
-const double PSO_DEF_INERTIA_FACTOR = 0.5;
 
 // ----------------------------------------------------------------------------
 // Class definitions
@@ -52,20 +53,30 @@ public:
   void setHistoryLength(uint value);
   // set how much history is important in changing speed, values 0..1
   void setInertiaFactor(double value);
+  /// generator used by swarm instead of global one (not owned)
+  void setRandomGenerator(scRandomGenerator *value);
   // -- run
   void execute(const scDataNode &itemRating, scDataNode &itemValues);
+  /// run whole optimization with driver: start from itemValues,
+  /// final positions are stored back to itemValues
+  void execute(scPsoDriver &driver, const scPsoFitnessFunction &fitness, scDataNode &itemValues);
   void reset();
+  // -- checkpoint
+  /// Restore swarm state saved by scPsoCheckpointWriter from getSwarm(),
+  /// param meta must be set as before. Background write of the same file
+  /// has to be finished (scPsoCheckpointWriter::wait()).
+  void loadCheckpoint(const scString &fileName);
+  // -- swarm
+  /// swarm core, can be used to set update mode, threads and seed
+  scPsoSwarm &getSwarm();
+  const scPsoSwarm &getSwarm() const;
 protected:  
-  void initVelocity(const scDataNode &itemValues);
-  void updateBestInfo(const scDataNode &itemRating, scDataNode &itemValues);
-  void getNeighbours(uint itemId, uint itemCount, scDataNode &output);
-  uint findLocalBest(const scDataNode &localItems);
-  void updateVelocity(const scDataNode &currPos);
-  void updatePosition(const scDataNode &velocity, scDataNode &itemValues);
+  void prepareSwarm(const scDataNode &itemValues);
+  void loadSwarm(const scDataNode &itemRating, const scDataNode &itemValues);
+  void loadPositions(const scDataNode &itemValues);
+  void storeSwarm(scDataNode &itemValues);
   virtual void postProcess(scDataNode &itemValues);
   scDataNodeValueType getValueType(int valueIndex);
-  double getCurrentScoreForItem(uint itemIndex);
-  void getCurrentParamValuesForItem(uint itemIndex, scDataNode &values);
   double getValueMinDouble(uint idx);
   double getValueMaxDouble(uint idx);
   int getValueMinInt(uint idx);
@@ -73,17 +84,9 @@ protected:
 protected:  
   // config
   scDataNode m_paramMeta;
-  double m_factor1;
-  double m_factor2;
-  double m_inertiaFactor;
-  uint m_historyLength;
+  bool m_metaChanged;
   // state
-  scDataNode m_bestItemScores;
-  scDataNode m_bestItemValues;
-  scDataNode m_itemVelocity;
-  scDataNode m_valueHistory;
-  scDataNode m_scoreHistory;
-  uint m_stepNo;
+  scPsoSwarm m_swarm;
 };
 
 #endif // _PSOOPTIMIZER_H__
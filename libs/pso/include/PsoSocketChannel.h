@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoSocketChannel.h
+// Project:     scLib
+// Purpose:     PSO migration channel using Unix datagram sockets
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSOSOCKETCHANNEL_H__
+#define _PSOSOCKETCHANNEL_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoSocketChannel.h
+///
+/// Migration channel using Unix datagram sockets (Boost.Asio), local stand-in
+/// for network transport. Available only where Boost.Asio supports local
+/// sockets (BOOST_ASIO_HAS_LOCAL_SOCKETS), not on Win32.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//boost
+#include "boost/ptr_container/ptr_vector.hpp"
+#include "boost/asio/io_service.hpp"
+#include "boost/asio/local/datagram_protocol.hpp"
+
+//sc
+#include "sc/alg/PsoMigration.h"
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// Socket of island is bound to "<pathPrefix><islandIdx>", only islands
+/// firstIsland..firstIsland+localCount-1 (running in this process) have
+/// socket, messages to other islands are sent to their paths.
+class scPsoSocketChannel: public scPsoMigrationChannel {
+public:
+  scPsoSocketChannel(const scString &pathPrefix, uint firstIsland, uint localCount);
+  virtual ~scPsoSocketChannel();
+  virtual void send(uint islandIdx, const double *values, uint paramCount, double score);
+  virtual bool receive(uint islandIdx, double *values, uint paramCount, double &score);
+protected:
+  scString getSocketPath(uint islandIdx) const;
+private:
+  scPsoSocketChannel(const scPsoSocketChannel &);
+  scPsoSocketChannel &operator=(const scPsoSocketChannel &);
+protected:
+  scString m_pathPrefix;
+  uint m_firstIsland;
+  boost::asio::io_service m_service;
+  boost::asio::local::datagram_protocol::socket m_sendSocket;
+  boost::ptr_vector<boost::asio::local::datagram_protocol::socket> m_sockets;
+};
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+#endif // _PSOSOCKETCHANNEL_H__
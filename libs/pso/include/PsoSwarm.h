@@ -0,0 +1,204 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoSwarm.h
+// Project:     scLib
+// Purpose:     PSO swarm state stored as dense arrays
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSOSWARM_H__
+#define _PSOSWARM_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoSwarm.h
+///
+/// Core of PSO optimizer working on structure-of-arrays state: for each
+/// parameter there is one contiguous array with value of all particles.
+/// Particles are identified by index 0..particleCount-1, neighbours are
+/// defined by scPsoTopology (ring i-1, i+1 by default). Higher score is better.
+///
+/// Can be used directly (fill positions and scores, call step()) or
+/// through scPsoOptimizer, which copies scDataNode input to the arrays.
+///
+/// In pum_block mode velocity and position are updated param by param for
+/// blocks of particles, with random values generated for whole block
+/// (scRandomLaneGenerator) and limits applied without branches. Each block
+/// has own random stream derived from seed, step and block number, so
+/// blocks can be processed in parallel and result does not depend on
+/// number of threads. Random values differ from pum_legacy, distribution
+/// of moves is the same.
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+#include "base/rand.h"
+
+//sc
+#include "sc/alg/PsoTopology.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+enum scPsoUpdateMode {
+  pum_legacy,  ///< particle by particle with global random generator (default)
+  pum_block    ///< blocks of particles, own random streams
+};
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const double PSO_DEF_FACTOR1 = 2.0;
+const double PSO_DEF_FACTOR2 = 2.0;
+const double PSO_DEF_INERTIA_FACTOR = 0.5;
+// number of particles updated at once in pum_block mode
+const uint PSO_BLOCK_SIZE = 256;
+// work values per block: 3 random values, neighbourhood best and new position for each particle
+const uint PSO_BLOCK_BUFFER_SIZE = 5 * PSO_BLOCK_SIZE;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+/// PSO swarm with state in dense arrays.
+/// In pum_legacy mode random values are drawn in the same order as in
+/// scPsoOptimizer before, so for the same random sequence results are the same.
+class scPsoSwarm {
+public:
+  // -- create
+  scPsoSwarm();
+  // -- properties
+  /// allocate state for given size, clears velocity, bests and history
+  void resize(uint particleCount, uint paramCount);
+  uint getParticleCount() const;
+  uint getParamCount() const;
+  /// range of param values, int params keep integer values
+  void setParamRange(uint paramIdx, double minValue, double maxValue, bool isInt);
+  double getParamMin(uint paramIdx) const;
+  double getParamMax(uint paramIdx) const;
+  bool isParamInt(uint paramIdx) const;
+  /// weights of attraction to particle best and to neighbourhood best
+  void setFactors(double factor1, double factor2);
+  /// how much previous velocity is kept, values 0..1
+  void setInertiaFactor(double value);
+  /// number of steps for which positions are remembered, 0 = personal best only
+  void setHistoryLength(uint value);
+  uint getStepNo() const;
+  void setUpdateMode(scPsoUpdateMode value);
+  /// number of worker threads in pum_block mode, 0 = OpenMP default, 1 = no threading (default)
+  void setThreadCount(uint value);
+  /// seed of random streams in pum_block mode, random if not set
+  void setSeed(uint64 value);
+  /// Generator used instead of global one (not owned): in pum_legacy mode for
+  /// all draws, in other cases for run seed when seed is not set.
+  void setRandomGenerator(scRandomGenerator *value);
+  /// neighbourhood of particles, changes are used from next step
+  scPsoTopology &getTopology();
+  const scPsoTopology &getTopology() const;
+  // -- state: arrays of particleCount values
+  double *getPosition(uint paramIdx);
+  const double *getPosition(uint paramIdx) const;
+  const double *getVelocity(uint paramIdx) const;
+  const double *getBestPosition(uint paramIdx) const;
+  /// scores of current positions, to be filled before step()
+  double *getScore();
+  const double *getScore() const;
+  const double *getBestScore() const;
+  /// copy paramCount values of particle from / to row
+  void setParticle(uint particleIdx, const double *values);
+  void getParticle(uint particleIdx, double *values) const;
+  // -- run
+  /// update bests with current scores, then velocity and position of all particles
+  void step();
+  /// Update best of one particle with its current score, then its velocity and
+  /// position. Used when scores of particles arrive one by one. Personal bests
+  /// of neighbours are used, history is ignored. Random values come from
+  /// stream of particle (see setSeed), not from global generator.
+  /// Step number advances every particleCount updates.
+  /// Not synchronized - only one particle can be updated at a time.
+  void stepParticle(uint particleIdx);
+  /// clear velocity, bests and history, positions are kept
+  void reset();
+protected:
+  void initVelocity();
+  void updateBest();
+  void updateBestFromHistory();
+  bool isBetterHistorySlot(uint particleIdx, uint newSlot, uint oldSlot) const;
+  const double *getLocalScores() const;
+  void prepareTopology(const double *scores);
+  uint findLocalBest(uint particleIdx) const;
+  void updateVelocity();
+  void updatePosition();
+  void initVelocityBlock();
+  void updateBlocks();
+  void updateParamBlock(uint paramIdx, uint beginPos, uint endPos, const double *localValues, uint64 blockKey,
+    double *buffer);
+  void prepareLocalBest();
+  uint64 getBlockKey(uint stepKey, uint taskIdx) const;
+  uint getBlockCount() const;
+  uint getWorkerCount() const;
+  void prepareRunSeed();
+  double drawDouble(double minValue, double maxValue);
+  void updateParticle(uint particleIdx);
+  uint64 getParticleKey(uint particleIdx) const;
+  double *getParamRow(std::vector<double> &values, uint paramIdx);
+  const double *getParamRow(const std::vector<double> &values, uint paramIdx) const;
+  // checkpoint copies whole state
+  friend class scPsoCheckpointWriter;
+  friend class scPsoCheckpointReader;
+protected:
+  // config
+  uint m_particleCount;
+  uint m_paramCount;
+  double m_factor1;
+  double m_factor2;
+  double m_inertiaFactor;
+  uint m_historyLength;
+  scPsoUpdateMode m_updateMode;
+  uint m_threadCount;
+  uint64 m_seed;
+  bool m_seedEnabled;
+  scRandomGenerator *m_randomSource;
+  std::vector<double> m_minValue;
+  std::vector<double> m_maxValue;
+  std::vector<bool> m_intParam;
+  scPsoTopology m_topology;
+  // state, paramCount rows of particleCount values
+  uint m_stepNo;
+  bool m_velocityValid;
+  bool m_bestValid;
+  std::vector<double> m_position;
+  std::vector<double> m_velocity;
+  std::vector<double> m_bestPosition;
+  std::vector<double> m_score;
+  std::vector<double> m_bestScore;
+  // history: historyLength slots of positions (as above) and scores
+  std::vector<double> m_historyPosition;
+  std::vector<double> m_historyScore;
+  // for each particle: ring of historyLength steps ordered by decreasing score
+  std::vector<uint> m_historyQueue;
+  std::vector<uint> m_queueBegin;
+  std::vector<uint> m_queueSize;
+  // step of best history item for each particle
+  std::vector<uint> m_bestStep;
+  std::vector<uint> m_changedBest;
+  // block mode
+  uint64 m_runSeed;
+  std::vector<uint> m_localBest;
+  std::vector<double> m_socialFactor;
+  // number of stepParticle() calls for each particle
+  std::vector<uint> m_particleStep;
+  // stepParticle() calls in current step, step number advances every particleCount calls
+  uint m_asyncUpdateCount;
+  // neighbourhood best prepared for personal bests, then updated per particle
+  bool m_asyncTopologyValid;
+};
+
+#endif // _PSOSWARM_H__
@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoTopology.h
+// Project:     scLib
+// Purpose:     Neighbourhood of PSO particles
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _PSOTOPOLOGY_H__
+#define _PSOTOPOLOGY_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/// \file PsoTopology.h
+///
+/// Defines which particles inform particle about their best positions.
+/// Neighbour lists are stored in one index array with offset of each
+/// particle (CSR), built once for particle count. First neighbour of each
+/// particle is particle itself, on equal score earlier neighbour wins.
+///
+/// Topologies:
+/// - ptt_ring: i, i-1, i+1, i-2, i+2, ... (neighbourCount on each side)
+/// - ptt_von_neumann: i and its left, right, upper and lower neighbour on
+///   grid with round(sqrt(particleCount)) columns, wrapped around
+/// - ptt_random: i and neighbourCount random other particles, drawn again
+///   every refreshInterval steps
+/// - ptt_global: all particles, no index is built - best of all particles
+///   is found once in prepareBest()
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+//std
+#include <vector>
+
+//base
+#include "base/btypes.h"
+#include "base/rand.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+enum scPsoTopologyType {
+  ptt_ring,         ///< default
+  ptt_von_neumann,
+  ptt_random,
+  ptt_global
+};
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint PSO_DEF_NEIGHBOUR_COUNT = 1;
+const uint PSO_DEF_TOPOLOGY_REFRESH = 10;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+class scPsoTopology {
+public:
+  // -- create
+  scPsoTopology();
+  // -- properties
+  void setType(scPsoTopologyType value);
+  scPsoTopologyType getType() const;
+  /// ptt_ring: neighbours on each side, ptt_random: number of random neighbours
+  void setNeighbourCount(uint value);
+  /// ptt_random: number of steps after which neighbours are drawn again, 0 = never
+  void setRefreshInterval(uint value);
+  /// seed for ptt_random, random if not set
+  void setSeed(uint64 value);
+  /// generator of seed for ptt_random when seed is not set (not owned)
+  void setRandomGenerator(scRandomGenerator *value);
+  // -- run
+  /// build index for particle count, for ptt_random draw neighbours again when needed
+  void prepare(uint particleCount, uint stepNo);
+  /// must be called before findBest() when scores change (ptt_global only)
+  void prepareBest(const double *scores);
+  /// score of one particle was increased, O(1) update of prepareBest() result (ptt_global only)
+  void updateBest(uint particleIdx, const double *scores);
+  /// neighbour of particle with highest score (may be particle itself)
+  uint findBest(uint particleIdx, const double *scores) const;
+  uint getNeighbourCount(uint particleIdx) const;
+  const uint *getNeighbours(uint particleIdx) const;
+protected:
+  void buildRing();
+  void buildVonNeumann();
+  void buildRandom(uint generation);
+  void addUniqueNeighbour(uint neighbourIdx);
+  friend class scPsoCheckpointWriter;
+  friend class scPsoCheckpointReader;
+protected:
+  // config
+  scPsoTopologyType m_type;
+  uint m_neighbourCount;
+  uint m_refreshInterval;
+  uint64 m_seed;
+  bool m_seedEnabled;
+  scRandomGenerator *m_randomSource;
+  // state
+  bool m_valid;
+  uint m_particleCount;
+  uint m_generation;
+  uint64 m_runSeed;
+  uint m_globalBest;
+  std::vector<uint> m_offset;
+  std::vector<uint> m_index;
+};
+
+#endif // _PSOTOPOLOGY_H__
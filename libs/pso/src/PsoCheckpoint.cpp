@@ -0,0 +1,420 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoCheckpoint.cpp
+// Project:     scLib
+// Purpose:     Binary checkpoint of PSO swarm state
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <climits>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "boost/bind.hpp"
+#include "boost/iostreams/device/mapped_file.hpp"
+#include "boost/filesystem/operations.hpp"
+
+#include "sc/alg/PsoCheckpoint.h"
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// Local definitions
+// ----------------------------------------------------------------------------
+static const char PSO_CHECKPOINT_MAGIC[4] = {'S', 'C', 'P', 'S'};
+
+static const uint PSO_CHECKPOINT_STATE_SECTIONS =
+  (1 << pcs_param_min) | (1 << pcs_param_max) | (1 << pcs_param_int) |
+  (1 << pcs_position) | (1 << pcs_velocity) | (1 << pcs_best_position) |
+  (1 << pcs_score) | (1 << pcs_best_score) | (1 << pcs_particle_step);
+
+static const uint PSO_CHECKPOINT_HISTORY_SECTIONS =
+  (1 << pcs_history_position) | (1 << pcs_history_score) | (1 << pcs_history_queue) |
+  (1 << pcs_queue_begin) | (1 << pcs_queue_size) | (1 << pcs_best_step);
+
+template < class T >
+static void putCheckpointField(char *buffer, uint offset, T value)
+{
+  memcpy(buffer + offset, &value, sizeof(T));
+}
+
+template < class T >
+static T getCheckpointField(const char *buffer, uint64 offset)
+{
+  T res;
+  memcpy(&res, buffer + offset, sizeof(T));
+  return res;
+}
+
+// size of section values padded to 8 bytes
+static uint64 getSectionDataSize(uint valueSize, uint64 valueCount)
+{
+  return (valueSize * valueCount + 7) & ~static_cast<uint64>(7);
+}
+
+// ----------------------------------------------------------------------------
+// scPsoCheckpointWriter
+// ----------------------------------------------------------------------------
+scPsoCheckpointWriter::scPsoCheckpointWriter()
+{
+}
+
+// destructor cannot throw, so error of last background write is printed
+scPsoCheckpointWriter::~scPsoCheckpointWriter()
+{
+  m_thread.join();
+  if (!m_error.empty())
+    std::cerr << "Checkpoint write failed: " << m_error << std::endl;
+}
+
+void scPsoCheckpointWriter::write(const scPsoSwarm &swarm, const dtpString &fileName)
+{
+  wait();
+  m_fileName = fileName;
+  prepareImage(swarm);
+  writeFile();
+  wait();
+}
+
+void scPsoCheckpointWriter::writeAsync(const scPsoSwarm &swarm, const dtpString &fileName)
+{
+  wait();
+  m_fileName = fileName;
+  prepareImage(swarm);
+  m_thread = boost::thread(boost::bind(&scPsoCheckpointWriter::writeFile, this));
+}
+
+void scPsoCheckpointWriter::wait()
+{
+  dtpString error;
+
+  m_thread.join();
+  if (!m_error.empty()) {
+    error.swap(m_error);
+    throw std::runtime_error(error);
+  }
+}
+
+// image capacity is kept between checkpoints
+void scPsoCheckpointWriter::prepareImage(const scPsoSwarm &swarm)
+{
+  const uint paramCount = swarm.m_paramCount;
+  std::vector<uint> intParam(paramCount);
+
+  for(uint j=0; j != paramCount; j++)
+    intParam[j] = swarm.m_intParam[j] ? 1 : 0;
+
+  m_image.clear();
+  writeHeader(swarm);
+  writeSection(pcs_param_min, swarm.m_minValue);
+  writeSection(pcs_param_max, swarm.m_maxValue);
+  writeSection(pcs_param_int, intParam);
+  writeSection(pcs_position, swarm.m_position);
+  writeSection(pcs_velocity, swarm.m_velocity);
+  writeSection(pcs_best_position, swarm.m_bestPosition);
+  writeSection(pcs_score, swarm.m_score);
+  writeSection(pcs_best_score, swarm.m_bestScore);
+  writeSection(pcs_particle_step, swarm.m_particleStep);
+
+  if (!swarm.m_historyScore.empty()) {
+    writeSection(pcs_history_position, swarm.m_historyPosition);
+    writeSection(pcs_history_score, swarm.m_historyScore);
+    writeSection(pcs_history_queue, swarm.m_historyQueue);
+    writeSection(pcs_queue_begin, swarm.m_queueBegin);
+    writeSection(pcs_queue_size, swarm.m_queueSize);
+    writeSection(pcs_best_step, swarm.m_bestStep);
+  }
+}
+
+void scPsoCheckpointWriter::writeHeader(const scPsoSwarm &swarm)
+{
+  const scPsoTopology &topology = swarm.m_topology;
+  uint64 randomState[RANDOM_STATE_SIZE];
+  uint flags = 0;
+  char *buffer;
+
+  if (swarm.m_velocityValid)
+    flags |= pcf_velocity_valid;
+  if (swarm.m_bestValid)
+    flags |= pcf_best_valid;
+  if (swarm.m_seedEnabled)
+    flags |= pcf_seed_enabled;
+  if (swarm.m_randomSource)
+    flags |= pcf_random_state;
+  if (!swarm.m_historyScore.empty())
+    flags |= pcf_history;
+
+  m_image.resize(PSO_CHECKPOINT_HEADER_SIZE, 0);
+  buffer = &m_image[0];
+
+  memcpy(buffer, PSO_CHECKPOINT_MAGIC, sizeof(PSO_CHECKPOINT_MAGIC));
+  putCheckpointField<uint>(buffer, 4, PSO_CHECKPOINT_BYTE_ORDER_MARK);
+  putCheckpointField<uint>(buffer, 8, PSO_CHECKPOINT_VERSION);
+  putCheckpointField<uint>(buffer, 12, flags);
+  putCheckpointField<uint>(buffer, 16, swarm.m_particleCount);
+  putCheckpointField<uint>(buffer, 20, swarm.m_paramCount);
+  putCheckpointField<uint>(buffer, 24, swarm.m_historyLength);
+  putCheckpointField<uint>(buffer, 28, static_cast<uint>(swarm.m_updateMode));
+  putCheckpointField<uint>(buffer, 32, swarm.m_stepNo);
+  putCheckpointField<uint>(buffer, 36, static_cast<uint>(topology.m_type));
+  putCheckpointField<double>(buffer, 40, swarm.m_factor1);
+  putCheckpointField<double>(buffer, 48, swarm.m_factor2);
+  putCheckpointField<double>(buffer, 56, swarm.m_inertiaFactor);
+  putCheckpointField<uint64>(buffer, 64, swarm.m_seed);
+  putCheckpointField<uint64>(buffer, 72, swarm.m_runSeed);
+
+  if (swarm.m_randomSource) {
+    swarm.m_randomSource->getState(randomState);
+    memcpy(buffer + 80, randomState, sizeof(randomState));
+  }
+
+  putCheckpointField<uint>(buffer, 112, topology.m_neighbourCount);
+  putCheckpointField<uint>(buffer, 116, topology.m_refreshInterval);
+  putCheckpointField<uint64>(buffer, 120, topology.m_runSeed);
+}
+
+template < class T >
+void scPsoCheckpointWriter::writeSection(scPsoCheckpointSection sectionId, const std::vector<T> &values)
+{
+  const size_t sectionOffset = m_image.size();
+  const uint64 dataSize = getSectionDataSize(sizeof(T), values.size());
+  char *buffer;
+
+  m_image.resize(sectionOffset + PSO_CHECKPOINT_SECTION_HEADER_SIZE + static_cast<size_t>(dataSize), 0);
+  buffer = &m_image[sectionOffset];
+
+  putCheckpointField<uint>(buffer, 0, static_cast<uint>(sectionId));
+  putCheckpointField<uint>(buffer, 4, sizeof(T));
+  putCheckpointField<uint64>(buffer, 8, values.size());
+  if (!values.empty())
+    memcpy(buffer + PSO_CHECKPOINT_SECTION_HEADER_SIZE, &values[0], values.size() * sizeof(T));
+}
+
+// runs on background thread in writeAsync(), errors are reported by wait()
+void scPsoCheckpointWriter::writeFile()
+{
+  const dtpString tempName = m_fileName + ".tmp";
+
+  try {
+    std::ofstream file(tempName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+      throw std::runtime_error("Cannot create checkpoint file: " + tempName);
+
+    file.write(&m_image[0], m_image.size());
+    file.close();
+    if (file.fail())
+      throw std::runtime_error("Cannot write checkpoint file: " + tempName);
+
+    boost::filesystem::rename(tempName, m_fileName);
+  } catch(std::exception &e) {
+    m_error = e.what();
+  }
+}
+
+// ----------------------------------------------------------------------------
+// scPsoCheckpointReader
+// ----------------------------------------------------------------------------
+void scPsoCheckpointReader::read(const dtpString &fileName, scPsoSwarm &swarm)
+{
+  boost::iostreams::mapped_file_source file;
+  const char *data;
+  uint64 size, offset, valueCount, dataSize, updateCount;
+  uint sectionId, valueSize;
+  bool valid;
+  std::vector<uint> intParam;
+
+  m_fileName = fileName;
+  m_sectionMask = 0;
+
+  try {
+    file.open(fileName);
+  } catch(std::exception &) {
+    throw std::runtime_error("Cannot open checkpoint file: " + fileName);
+  }
+
+  data = file.data();
+  size = file.size();
+
+  readHeader(data, size, swarm);
+
+  for(offset = PSO_CHECKPOINT_HEADER_SIZE; offset < size; offset += PSO_CHECKPOINT_SECTION_HEADER_SIZE + dataSize)
+  {
+    if (offset + PSO_CHECKPOINT_SECTION_HEADER_SIZE > size)
+      throw std::runtime_error("Checkpoint file is truncated: " + fileName);
+
+    sectionId = getCheckpointField<uint>(data, offset);
+    valueSize = getCheckpointField<uint>(data, offset + 4);
+    valueCount = getCheckpointField<uint64>(data, offset + 8);
+
+    // checked by division, size of values could wrap around and move offset back
+    if (valueSize && 
+        (valueCount > (size - offset - PSO_CHECKPOINT_SECTION_HEADER_SIZE) / valueSize))
+      throw std::runtime_error("Checkpoint file is truncated: " + fileName);
+
+    dataSize = getSectionDataSize(valueSize, valueCount);
+    if (offset + PSO_CHECKPOINT_SECTION_HEADER_SIZE + dataSize > size)
+      throw std::runtime_error("Checkpoint file is truncated: " + fileName);
+
+    switch (sectionId) {
+      case pcs_param_min:
+        valid = readSection(data + offset, valueSize, swarm.m_paramCount, swarm.m_minValue);
+        break;
+      case pcs_param_max:
+        valid = readSection(data + offset, valueSize, swarm.m_paramCount, swarm.m_maxValue);
+        break;
+      case pcs_param_int:
+        valid = readSection(data + offset, valueSize, swarm.m_paramCount, intParam);
+        for(uint j=0, epos = intParam.size(); j != epos; j++)
+          swarm.m_intParam[j] = (intParam[j] != 0);
+        break;
+      case pcs_position:
+        valid = readSection(data + offset, valueSize, swarm.m_position.size(), swarm.m_position);
+        break;
+      case pcs_velocity:
+        valid = readSection(data + offset, valueSize, swarm.m_velocity.size(), swarm.m_velocity);
+        break;
+      case pcs_best_position:
+        valid = readSection(data + offset, valueSize, swarm.m_bestPosition.size(), swarm.m_bestPosition);
+        break;
+      case pcs_score:
+        valid = readSection(data + offset, valueSize, swarm.m_particleCount, swarm.m_score);
+        break;
+      case pcs_best_score:
+        valid = readSection(data + offset, valueSize, swarm.m_particleCount, swarm.m_bestScore);
+        break;
+      case pcs_particle_step:
+        valid = readSection(data + offset, valueSize, swarm.m_particleCount, swarm.m_particleStep);
+        break;
+      case pcs_history_position:
+        valid = readSection(data + offset, valueSize, swarm.m_position.size() * swarm.m_historyLength,
+          swarm.m_historyPosition);
+        break;
+      case pcs_history_score:
+        valid = readSection(data + offset, valueSize, static_cast<uint64>(swarm.m_particleCount) * swarm.m_historyLength,
+          swarm.m_historyScore);
+        break;
+      case pcs_history_queue:
+        valid = readSection(data + offset, valueSize, static_cast<uint64>(swarm.m_particleCount) * swarm.m_historyLength,
+          swarm.m_historyQueue);
+        break;
+      case pcs_queue_begin:
+        valid = readSection(data + offset, valueSize, swarm.m_particleCount, swarm.m_queueBegin);
+        break;
+      case pcs_queue_size:
+        valid = readSection(data + offset, valueSize, swarm.m_particleCount, swarm.m_queueSize);
+        break;
+      case pcs_best_step:
+        valid = readSection(data + offset, valueSize, swarm.m_particleCount, swarm.m_bestStep);
+        break;
+      default:
+        valid = true;
+    }
+
+    if (!valid)
+      throw std::runtime_error("Wrong section in checkpoint file: " + fileName);
+    if (sectionId < 32)
+      m_sectionMask |= (1 << sectionId);
+  }
+
+  if ((m_sectionMask & PSO_CHECKPOINT_STATE_SECTIONS) != PSO_CHECKPOINT_STATE_SECTIONS)
+    throw std::runtime_error("Missing section in checkpoint file: " + fileName);
+
+  if (m_flags & pcf_history) {
+    if ((m_sectionMask & PSO_CHECKPOINT_HISTORY_SECTIONS) != PSO_CHECKPOINT_HISTORY_SECTIONS)
+      throw std::runtime_error("Missing history in checkpoint file: " + fileName);
+    swarm.m_changedBest.reserve(swarm.m_particleCount);
+  } else {
+    swarm.m_historyPosition.clear();
+    swarm.m_historyScore.clear();
+  }
+
+  // position inside step of particle-by-particle updates is not stored,
+  // it follows from number of updates since start of run
+  updateCount = 0;
+  for(uint i=0; i != swarm.m_particleCount; i++)
+    updateCount += swarm.m_particleStep[i];
+  swarm.m_asyncUpdateCount = swarm.m_particleCount ? static_cast<uint>(updateCount % swarm.m_particleCount) : 0;
+  swarm.m_asyncTopologyValid = false;
+}
+
+// swarm is resized and configured with header values
+void scPsoCheckpointReader::readHeader(const char *data, uint64 size, scPsoSwarm &swarm)
+{
+  uint64 randomState[RANDOM_STATE_SIZE];
+  scPsoTopology &topology = swarm.m_topology;
+  uint particleCount, paramCount, historyLength;
+  uint64 stateCount, valueLimit;
+
+  if (size < PSO_CHECKPOINT_HEADER_SIZE)
+    throw std::runtime_error("Checkpoint file too short: " + m_fileName);
+  if (memcmp(data, PSO_CHECKPOINT_MAGIC, sizeof(PSO_CHECKPOINT_MAGIC)) != 0)
+    throw std::runtime_error("Not a checkpoint file: " + m_fileName);
+  if (getCheckpointField<uint>(data, 4) != PSO_CHECKPOINT_BYTE_ORDER_MARK)
+    throw std::runtime_error("Unsupported byte order of checkpoint file: " + m_fileName);
+  if (getCheckpointField<uint>(data, 8) != PSO_CHECKPOINT_VERSION)
+    throw std::runtime_error("Unsupported version of checkpoint file: " + m_fileName);
+
+  m_flags = getCheckpointField<uint>(data, 12);
+  particleCount = getCheckpointField<uint>(data, 16);
+  paramCount = getCheckpointField<uint>(data, 20);
+  historyLength = getCheckpointField<uint>(data, 24);
+
+  // required sections (3 x particles x params values, history if stored) have to
+  // fit in file, so corrupted counts are rejected before swarm is allocated
+  stateCount = static_cast<uint64>(particleCount) * paramCount;
+  valueLimit = size / sizeof(double);
+  if ((particleCount > valueLimit) || (paramCount > valueLimit) || (stateCount > valueLimit / 3) ||
+      ((m_flags & pcf_history) && historyLength && (stateCount > valueLimit / historyLength)))
+    throw std::runtime_error("Wrong swarm size in checkpoint file: " + m_fileName);
+
+  swarm.resize(particleCount, paramCount);
+  swarm.setHistoryLength(historyLength);
+  swarm.setUpdateMode(static_cast<scPsoUpdateMode>(getCheckpointField<uint>(data, 28)));
+  swarm.setFactors(getCheckpointField<double>(data, 40), getCheckpointField<double>(data, 48));
+  swarm.setInertiaFactor(getCheckpointField<double>(data, 56));
+
+  swarm.m_stepNo = getCheckpointField<uint>(data, 32);
+  swarm.m_velocityValid = ((m_flags & pcf_velocity_valid) != 0);
+  swarm.m_bestValid = ((m_flags & pcf_best_valid) != 0);
+  swarm.m_seed = getCheckpointField<uint64>(data, 64);
+  swarm.m_seedEnabled = ((m_flags & pcf_seed_enabled) != 0);
+  swarm.m_runSeed = getCheckpointField<uint64>(data, 72);
+  swarm.m_historyQueue.clear();
+  swarm.m_queueBegin.clear();
+  swarm.m_queueSize.clear();
+  swarm.m_bestStep.clear();
+
+  if ((m_flags & pcf_random_state) && swarm.m_randomSource) {
+    memcpy(randomState, data + 80, sizeof(randomState));
+    swarm.m_randomSource->setState(randomState);
+  }
+
+  topology.setType(static_cast<scPsoTopologyType>(getCheckpointField<uint>(data, 36)));
+  topology.setNeighbourCount(getCheckpointField<uint>(data, 112));
+  topology.setRefreshInterval(getCheckpointField<uint>(data, 116));
+
+  // random neighbours are drawn again from saved run seed when index is prepared
+  if (topology.m_type == ptt_random) {
+    topology.m_runSeed = getCheckpointField<uint64>(data, 120);
+    topology.m_particleCount = swarm.m_particleCount;
+    topology.m_generation = UINT_MAX;
+    topology.m_valid = true;
+  }
+}
+
+template < class T >
+bool scPsoCheckpointReader::readSection(const char *sectionPtr, uint valueSize, uint64 valueCount, std::vector<T> &output)
+{
+  if ((valueSize != sizeof(T)) || (getCheckpointField<uint64>(sectionPtr, 8) != valueCount))
+    return false;
+
+  output.resize(static_cast<size_t>(valueCount));
+  if (valueCount)
+    memcpy(&output[0], sectionPtr + PSO_CHECKPOINT_SECTION_HEADER_SIZE, static_cast<size_t>(valueCount) * sizeof(T));
+  return true;
+}
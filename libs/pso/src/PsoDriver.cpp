@@ -0,0 +1,183 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoDriver.cpp
+// Project:     scLib
+// Purpose:     PSO loop with parallel fitness evaluation
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <deque>
+#include <cmath>
+
+#include "sc/alg/PsoDriver.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scPsoDriver
+// ----------------------------------------------------------------------------
+scPsoDriver::scPsoDriver()
+{
+  m_mode = pdm_sync;
+  m_threadCount = 0;
+  m_stepLimit = PSO_DEF_STEP_LIMIT;
+  m_bestScore = -HUGE_VAL;
+  m_evalCount = 0;
+}
+
+void scPsoDriver::setMode(scPsoDriverMode value)
+{
+  m_mode = value;
+}
+
+void scPsoDriver::setThreadCount(uint value)
+{
+  m_threadCount = value;
+}
+
+void scPsoDriver::setStepLimit(uint value)
+{
+  m_stepLimit = value;
+}
+
+double scPsoDriver::getBestScore() const
+{
+  return m_bestScore;
+}
+
+const std::vector<double> &scPsoDriver::getBestValues() const
+{
+  return m_bestValues;
+}
+
+uint scPsoDriver::getEvalCount() const
+{
+  return m_evalCount;
+}
+
+uint scPsoDriver::getWorkerCount() const
+{
+#ifdef _OPENMP
+  if (!m_threadCount)
+    return omp_get_max_threads();
+#endif
+  return m_threadCount ? m_threadCount : 1;
+}
+
+void scPsoDriver::execute(scPsoSwarm &swarm, const scPsoFitnessFunction &fitness)
+{
+  m_bestScore = -HUGE_VAL;
+  m_bestValues.clear();
+  m_evalCount = 0;
+
+  if (!swarm.getParticleCount())
+    return;
+
+  if (m_mode == pdm_async)
+    runAsync(swarm, fitness);
+  else
+    runSync(swarm, fitness);
+}
+
+void scPsoDriver::updateBest(double score, const double *values, uint paramCount)
+{
+  if (m_bestValues.empty() || (score > m_bestScore)) {
+    m_bestScore = score;
+    m_bestValues.assign(values, values + paramCount);
+  }
+}
+
+// generation: evaluate all particles in parallel, then update swarm
+void scPsoDriver::runSync(scPsoSwarm &swarm, const scPsoFitnessFunction &fitness)
+{
+  const uint particleCount = swarm.getParticleCount();
+  const uint paramCount = swarm.getParamCount();
+  const int evalCount = static_cast<int>(particleCount);
+  double *score = swarm.getScore();
+  std::vector<double> values(paramCount);
+
+  for(uint s=0; s != m_stepLimit; s++)
+  {
+#pragma omp parallel num_threads(getWorkerCount()) if(evalCount > 1)
+    {
+      std::vector<double> particleValues(paramCount);
+
+#pragma omp for schedule(dynamic)
+      for(int i = 0; i < evalCount; i++)
+      {
+        swarm.getParticle(static_cast<uint>(i), &particleValues[0]);
+        score[i] = fitness.calcFitness(&particleValues[0], paramCount);
+      }
+    }
+
+    // first particle wins on equal score
+    for(uint i=0; i != particleCount; i++)
+      if (m_bestValues.empty() || (score[i] > m_bestScore)) {
+        swarm.getParticle(i, &values[0]);
+        updateBest(score[i], &values[0], paramCount);
+      }
+
+    m_evalCount += particleCount;
+    swarm.step();
+  }
+}
+
+// Particles wait for evaluation in queue. Worker takes particle, evaluates
+// its copy of values outside of lock, then updates it and puts it back.
+// Queue is empty only when all particles are evaluated, then worker ends -
+// there are more threads than particles.
+void scPsoDriver::runAsync(scPsoSwarm &swarm, const scPsoFitnessFunction &fitness)
+{
+  const uint particleCount = swarm.getParticleCount();
+  const uint paramCount = swarm.getParamCount();
+  const uint evalLimit = m_stepLimit * particleCount;
+  double *score = swarm.getScore();
+  std::deque<uint> waiting;
+  uint startedCount = 0;
+
+  for(uint i=0; i != particleCount; i++)
+    waiting.push_back(i);
+
+#pragma omp parallel num_threads(getWorkerCount()) if(evalLimit > 1)
+  {
+    std::vector<double> particleValues(paramCount);
+    double particleScore;
+    uint particleIdx = 0;
+    bool found;
+
+    for(;;)
+    {
+#pragma omp critical(scPsoDriver)
+      {
+        found = (startedCount < evalLimit) && !waiting.empty();
+        if (found) {
+          particleIdx = waiting.front();
+          waiting.pop_front();
+          startedCount++;
+          swarm.getParticle(particleIdx, &particleValues[0]);
+        }
+      }
+
+      if (!found)
+        break;
+
+      particleScore = fitness.calcFitness(&particleValues[0], paramCount);
+
+#pragma omp critical(scPsoDriver)
+      {
+        updateBest(particleScore, &particleValues[0], paramCount);
+        m_evalCount++;
+        score[particleIdx] = particleScore;
+        swarm.stepParticle(particleIdx);
+        waiting.push_back(particleIdx);
+      }
+    }
+  }
+}
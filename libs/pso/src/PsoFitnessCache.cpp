@@ -0,0 +1,282 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoFitnessCache.cpp
+// Project:     scLib
+// Purpose:     Cache and surrogate model for expensive PSO fitness
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cmath>
+
+#include "boost/thread/locks.hpp"
+
+#include "sc/alg/PsoFitnessCache.h"
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scPsoCachedFitness
+// ----------------------------------------------------------------------------
+scPsoCachedFitness::scPsoCachedFitness(const scPsoFitnessFunction &evaluator, uint paramCount):
+  m_evaluator(evaluator)
+{
+  m_paramCount = paramCount;
+  m_quantum.assign(paramCount, 0.0);
+  m_distanceScale.assign(paramCount, 1.0);
+  m_capacity = PSO_DEF_CACHE_CAPACITY;
+  m_neighbourCount = 0;
+  m_minSampleCount = PSO_DEF_SURROGATE_MIN_SAMPLES;
+  m_screenQuantile = PSO_DEF_SURROGATE_QUANTILE;
+  m_screenedScore = -HUGE_VAL;
+  m_callCount = m_hitCount = m_screenedCount = m_evalCount = 0;
+}
+
+void scPsoCachedFitness::setQuantum(uint paramIdx, double value)
+{
+  m_quantum[paramIdx] = value;
+}
+
+void scPsoCachedFitness::setCapacity(uint value)
+{
+  m_capacity = value;
+}
+
+void scPsoCachedFitness::setSurrogate(uint neighbourCount, uint minSampleCount, double screenQuantile)
+{
+  m_neighbourCount = std::min<uint>(neighbourCount, PSO_MAX_SURROGATE_NEIGHBOURS);
+  m_minSampleCount = std::max<uint>(minSampleCount, 1);
+  m_screenQuantile = std::max<double>(0.0, std::min<double>(screenQuantile, 1.0));
+  balanceScoreHeaps();
+}
+
+void scPsoCachedFitness::setScreenedScore(double value)
+{
+  m_screenedScore = value;
+}
+
+void scPsoCachedFitness::setDistanceScale(uint paramIdx, double value)
+{
+  m_distanceScale[paramIdx] = value;
+}
+
+void scPsoCachedFitness::clear()
+{
+  boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+  m_index.clear();
+  m_sampleValues.clear();
+  m_sampleScore.clear();
+  m_lowScore.clear();
+  m_highScore.clear();
+  m_callCount = m_hitCount = m_screenedCount = m_evalCount = 0;
+}
+
+uint scPsoCachedFitness::getCallCount() const
+{
+  return m_callCount;
+}
+
+uint scPsoCachedFitness::getHitCount() const
+{
+  return m_hitCount;
+}
+
+uint scPsoCachedFitness::getScreenedCount() const
+{
+  return m_screenedCount;
+}
+
+uint scPsoCachedFitness::getEvalCount() const
+{
+  return m_evalCount;
+}
+
+double scPsoCachedFitness::getHitRate() const
+{
+  return m_callCount ? static_cast<double>(m_hitCount) / m_callCount : 0.0;
+}
+
+uint scPsoCachedFitness::getSavedCount() const
+{
+  return m_hitCount + m_screenedCount;
+}
+
+double scPsoCachedFitness::calcFitness(const double *values, uint paramCount) const
+{
+  scPsoCacheKey key;
+  scPsoCacheMap::const_iterator it;
+  double res = 0.0;
+  bool found, screened = false;
+
+  prepareKey(values, key);
+
+#pragma omp atomic
+  m_callCount++;
+
+  {
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    it = m_index.find(key);
+    found = (it != m_index.end());
+    if (found)
+      res = m_sampleScore[it->second];
+    else
+      screened = predictScore(values, res) && (res < getScreenLimit());
+  }
+
+  if (found) {
+#pragma omp atomic
+    m_hitCount++;
+    return res;
+  }
+
+  // prediction is not a real score, it must not become best position
+  if (screened) {
+#pragma omp atomic
+    m_screenedCount++;
+    return m_screenedScore;
+  }
+
+  res = m_evaluator.calcFitness(values, paramCount);
+
+#pragma omp atomic
+  m_evalCount++;
+
+  {
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    storeResult(key, values, res);
+  }
+
+  return res;
+}
+
+// exact values are keyed by bits, -0.0 is the same as 0.0
+void scPsoCachedFitness::prepareKey(const double *values, scPsoCacheKey &output) const
+{
+  double value;
+
+  output.resize(m_paramCount);
+  for(uint j=0; j != m_paramCount; j++)
+  {
+    if (m_quantum[j] > 0.0) {
+      output[j] = static_cast<int64>(std::floor(values[j] / m_quantum[j] + 0.5));
+    } else {
+      value = (values[j] == 0.0) ? 0.0 : values[j];
+      memcpy(&output[j], &value, sizeof(value));
+    }
+  }
+}
+
+// Inverse distance weighting of k nearest samples, exact match gives its score.
+// Returns false when surrogate is disabled or there are not enough samples.
+// Nearest samples are kept sorted in fixed arrays, ties in sample order.
+bool scPsoCachedFitness::predictScore(const double *values, double &output) const
+{
+  const uint sampleCount = m_sampleScore.size();
+  const double *samplePtr = m_sampleValues.empty() ? NULL : &m_sampleValues[0];
+  double nearDist[PSO_MAX_SURROGATE_NEIGHBOURS];
+  uint nearIdx[PSO_MAX_SURROGATE_NEIGHBOURS];
+  uint nearCount = 0;
+  double dist, diff, weight, weightSum;
+  uint pos;
+
+  if (!m_neighbourCount || (sampleCount < m_minSampleCount))
+    return false;
+
+  for(uint s=0; s != sampleCount; s++, samplePtr += m_paramCount)
+  {
+    dist = 0.0;
+    for(uint j=0; j != m_paramCount; j++)
+    {
+      diff = (values[j] - samplePtr[j]) * m_distanceScale[j];
+      dist += diff * diff;
+    }
+
+    if ((nearCount == m_neighbourCount) && (dist >= nearDist[nearCount - 1]))
+      continue;
+
+    // last one is dropped when arrays are full
+    if (nearCount < m_neighbourCount)
+      nearCount++;
+    for(pos = nearCount - 1; (pos > 0) && (nearDist[pos - 1] > dist); pos--)
+    {
+      nearDist[pos] = nearDist[pos - 1];
+      nearIdx[pos] = nearIdx[pos - 1];
+    }
+    nearDist[pos] = dist;
+    nearIdx[pos] = s;
+  }
+
+  if (nearDist[0] == 0.0) {
+    output = m_sampleScore[nearIdx[0]];
+    return true;
+  }
+
+  output = weightSum = 0.0;
+  for(uint k=0; k != nearCount; k++)
+  {
+    weight = 1.0 / nearDist[k];
+    output += weight * m_sampleScore[nearIdx[k]];
+    weightSum += weight;
+  }
+  output /= weightSum;
+  return true;
+}
+
+// score at screen quantile of sorted evaluated scores, at least one score required
+double scPsoCachedFitness::getScreenLimit() const
+{
+  return m_lowScore.front();
+}
+
+// key evaluated twice at once is stored once
+void scPsoCachedFitness::storeResult(const scPsoCacheKey &key, const double *values, double score) const
+{
+  if ((m_capacity && (m_sampleScore.size() >= m_capacity)) || (m_index.find(key) != m_index.end()))
+    return;
+
+  m_index[key] = m_sampleScore.size();
+  m_sampleScore.push_back(score);
+  m_sampleValues.insert(m_sampleValues.end(), values, values + m_paramCount);
+
+  if (m_lowScore.empty() || (score < m_lowScore.front())) {
+    m_lowScore.push_back(score);
+    std::push_heap(m_lowScore.begin(), m_lowScore.end());
+  } else {
+    m_highScore.push_back(score);
+    std::push_heap(m_highScore.begin(), m_highScore.end(), std::greater<double>());
+  }
+  balanceScoreHeaps();
+}
+
+// Move scores between heaps, so lower one keeps scores up to position
+// quantile x (count - 1) of sorted scores. Each insert moves at most one.
+void scPsoCachedFitness::balanceScoreHeaps() const
+{
+  const size_t scoreCount = m_lowScore.size() + m_highScore.size();
+  size_t lowCount;
+
+  if (!scoreCount)
+    return;
+
+  lowCount = static_cast<size_t>(m_screenQuantile * (scoreCount - 1)) + 1;
+
+  while (m_lowScore.size() > lowCount) {
+    std::pop_heap(m_lowScore.begin(), m_lowScore.end());
+    m_highScore.push_back(m_lowScore.back());
+    std::push_heap(m_highScore.begin(), m_highScore.end(), std::greater<double>());
+    m_lowScore.pop_back();
+  }
+
+  while (m_lowScore.size() < lowCount) {
+    std::pop_heap(m_highScore.begin(), m_highScore.end(), std::greater<double>());
+    m_lowScore.push_back(m_highScore.back());
+    std::push_heap(m_lowScore.begin(), m_lowScore.end());
+    m_highScore.pop_back();
+  }
+}
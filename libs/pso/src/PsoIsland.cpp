@@ -0,0 +1,299 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoIsland.cpp
+// Project:     scLib
+// Purpose:     Island model: several PSO swarms exchanging best particles
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include "sc/alg/PsoIsland.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// Local definitions
+// ----------------------------------------------------------------------------
+// orders particle indices by score, on equal score lower index first
+class scPsoScoreOrder {
+public:
+  scPsoScoreOrder(const double *score, bool descending): m_score(score), m_descending(descending) {}
+  bool operator()(uint left, uint right) const {
+    if (m_score[left] != m_score[right])
+      return (m_score[left] > m_score[right]) == m_descending;
+    return left < right;
+  }
+protected:
+  const double *m_score;
+  bool m_descending;
+};
+
+// ----------------------------------------------------------------------------
+// scPsoIslandModel
+// ----------------------------------------------------------------------------
+scPsoIslandModel::scPsoIslandModel()
+{
+  m_firstIslandIdx = 0;
+  m_totalIslandCount = 0;
+  m_channel = NULL;
+  m_migrationInterval = PSO_DEF_MIGRATION_INTERVAL;
+  m_migrantCount = PSO_DEF_MIGRANT_COUNT;
+  m_stepLimit = PSO_DEF_STEP_LIMIT;
+  m_mode = pdm_sync;
+  m_threadCount = 0;
+  m_seed = 0;
+  m_seedEnabled = false;
+  m_bestScore = -HUGE_VAL;
+  m_bestIsland = 0;
+  m_evalCount = 0;
+  m_receivedCount = 0;
+}
+
+void scPsoIslandModel::setIslandCount(uint value)
+{
+  m_islands.clear();
+  m_islands.resize(value);
+}
+
+uint scPsoIslandModel::getIslandCount() const
+{
+  return m_islands.size();
+}
+
+scPsoSwarm &scPsoIslandModel::getIsland(uint islandIdx)
+{
+  return m_islands[islandIdx];
+}
+
+const scPsoSwarm &scPsoIslandModel::getIsland(uint islandIdx) const
+{
+  return m_islands[islandIdx];
+}
+
+void scPsoIslandModel::setGlobalIslands(uint firstIdx, uint totalCount)
+{
+  m_firstIslandIdx = firstIdx;
+  m_totalIslandCount = totalCount;
+}
+
+void scPsoIslandModel::setChannel(scPsoMigrationChannel *value)
+{
+  m_channel = value;
+}
+
+void scPsoIslandModel::setMigrationInterval(uint value)
+{
+  m_migrationInterval = value;
+}
+
+void scPsoIslandModel::setMigrantCount(uint value)
+{
+  m_migrantCount = value;
+}
+
+void scPsoIslandModel::setStepLimit(uint value)
+{
+  m_stepLimit = value;
+}
+
+void scPsoIslandModel::setMode(scPsoDriverMode value)
+{
+  m_mode = value;
+}
+
+void scPsoIslandModel::setThreadCount(uint value)
+{
+  m_threadCount = value;
+}
+
+void scPsoIslandModel::setSeed(uint64 value)
+{
+  m_seed = value;
+  m_seedEnabled = true;
+}
+
+double scPsoIslandModel::getBestScore() const
+{
+  return m_bestScore;
+}
+
+const std::vector<double> &scPsoIslandModel::getBestValues() const
+{
+  return m_bestValues;
+}
+
+uint scPsoIslandModel::getBestIsland() const
+{
+  return m_bestIsland;
+}
+
+uint scPsoIslandModel::getEvalCount() const
+{
+  return m_evalCount;
+}
+
+uint scPsoIslandModel::getReceivedCount() const
+{
+  return m_receivedCount;
+}
+
+uint scPsoIslandModel::getTotalIslandCount() const
+{
+  return m_totalIslandCount ? m_totalIslandCount : m_firstIslandIdx + m_islands.size();
+}
+
+uint scPsoIslandModel::getWorkerCount() const
+{
+#ifdef _OPENMP
+  if (!m_threadCount)
+    return omp_get_max_threads();
+#endif
+  return m_threadCount ? m_threadCount : 1;
+}
+
+// Island streams are split for all islands of model, so processes using
+// the same seed give different streams to their islands.
+void scPsoIslandModel::execute(const scPsoFitnessFunction &fitness)
+{
+  const uint islandCount = m_islands.size();
+  const int taskCount = static_cast<int>(islandCount);
+  std::vector<scRandomGenerator> streams;
+  scPsoMemoryChannel localChannel(m_channel ? 0 : getTotalIslandCount());
+  scPsoMigrationChannel &channel = m_channel ? *m_channel : localChannel;
+
+  m_bestScore = -HUGE_VAL;
+  m_bestValues.clear();
+  m_bestIsland = 0;
+  m_evalCount = 0;
+  m_receivedCount = 0;
+
+  splitRandomStreams(scRandomGenerator(m_seedEnabled ? m_seed : randomHash(randomUInt64())),
+    getTotalIslandCount(), streams);
+  m_random.assign(streams.begin() + m_firstIslandIdx, streams.begin() + m_firstIslandIdx + islandCount);
+
+  m_islandBestScore.assign(islandCount, -HUGE_VAL);
+  m_islandBestValues.assign(islandCount, std::vector<double>());
+  m_islandEvalCount.assign(islandCount, 0);
+  m_islandReceivedCount.assign(islandCount, 0);
+
+  for(uint k=0; k != islandCount; k++)
+    m_islands[k].setRandomGenerator(&m_random[k]);
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(taskCount > 1)
+  for(int k = 0; k < taskCount; k++)
+    runIsland(static_cast<uint>(k), fitness, channel);
+
+  // first island wins on equal score
+  for(uint k=0; k != islandCount; k++)
+  {
+    if (!m_islandBestValues[k].empty() && (m_bestValues.empty() || (m_islandBestScore[k] > m_bestScore))) {
+      m_bestScore = m_islandBestScore[k];
+      m_bestValues = m_islandBestValues[k];
+      m_bestIsland = m_firstIslandIdx + k;
+    }
+    m_evalCount += m_islandEvalCount[k];
+    m_receivedCount += m_islandReceivedCount[k];
+  }
+}
+
+// island is optimized by its driver in epochs of migration interval
+void scPsoIslandModel::runIsland(uint islandIdx, const scPsoFitnessFunction &fitness, scPsoMigrationChannel &channel)
+{
+  const uint epochLength = m_migrationInterval ? m_migrationInterval : m_stepLimit;
+  scPsoSwarm &swarm = m_islands[islandIdx];
+  scPsoDriver driver;
+  uint stepNo = 0;
+  uint stepCount;
+
+  if (!swarm.getParticleCount())
+    return;
+
+  driver.setMode(m_mode);
+  driver.setThreadCount(1);
+
+  while (stepNo < m_stepLimit) {
+    stepCount = std::min(epochLength, m_stepLimit - stepNo);
+    driver.setStepLimit(stepCount);
+    driver.execute(swarm, fitness);
+    stepNo += stepCount;
+
+    if (m_islandBestValues[islandIdx].empty() || (driver.getBestScore() > m_islandBestScore[islandIdx])) {
+      m_islandBestScore[islandIdx] = driver.getBestScore();
+      m_islandBestValues[islandIdx] = driver.getBestValues();
+    }
+    m_islandEvalCount[islandIdx] += driver.getEvalCount();
+
+    if (m_migrationInterval && swarm.getParamCount() && (stepNo < m_stepLimit)) {
+      sendMigrants(islandIdx, channel);
+      m_islandReceivedCount[islandIdx] += receiveMigrants(islandIdx, channel);
+    }
+  }
+}
+
+// personal bests of best particles are sent to next island
+void scPsoIslandModel::sendMigrants(uint islandIdx, scPsoMigrationChannel &channel)
+{
+  const scPsoSwarm &swarm = m_islands[islandIdx];
+  const uint particleCount = swarm.getParticleCount();
+  const uint paramCount = swarm.getParamCount();
+  const uint sendCount = std::min(m_migrantCount, particleCount);
+  const uint totalCount = getTotalIslandCount();
+  const uint targetIdx = (m_firstIslandIdx + islandIdx + 1) % totalCount;
+  const double *bestScore = swarm.getBestScore();
+  std::vector<uint> order(particleCount);
+  std::vector<double> values(paramCount);
+  uint particleIdx;
+
+  if ((totalCount < 2) || !sendCount)
+    return;
+
+  for(uint i=0; i != particleCount; i++)
+    order[i] = i;
+  std::partial_sort(order.begin(), order.begin() + sendCount, order.end(), scPsoScoreOrder(bestScore, true));
+
+  for(uint m=0; m != sendCount; m++)
+  {
+    particleIdx = order[m];
+    for(uint j=0; j != paramCount; j++)
+      values[j] = swarm.getBestPosition(j)[particleIdx];
+    channel.send(targetIdx, &values[0], paramCount, bestScore[particleIdx]);
+  }
+}
+
+// Received particle replaces current position of particle with worst personal
+// best if it is better than that best, it is evaluated in next generation.
+// Returns number of placed particles.
+uint scPsoIslandModel::receiveMigrants(uint islandIdx, scPsoMigrationChannel &channel)
+{
+  scPsoSwarm &swarm = m_islands[islandIdx];
+  const uint particleCount = swarm.getParticleCount();
+  const uint paramCount = swarm.getParamCount();
+  const uint globalIdx = m_firstIslandIdx + islandIdx;
+  const uint receiveLimit = std::min(m_migrantCount, particleCount);
+  const double *bestScore = swarm.getBestScore();
+  std::vector<uint> order(particleCount);
+  std::vector<double> values(paramCount);
+  double score;
+  uint res = 0;
+
+  for(uint i=0; i != particleCount; i++)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), scPsoScoreOrder(bestScore, false));
+
+  for(uint m=0; (m != receiveLimit) && channel.receive(globalIdx, &values[0], paramCount, score); m++)
+    if (score > bestScore[order[res]]) {
+      swarm.setParticle(order[res], &values[0]);
+      res++;
+    }
+
+  return res;
+}
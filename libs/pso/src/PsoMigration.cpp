@@ -0,0 +1,108 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoMigration.cpp
+// Project:     scLib
+// Purpose:     Channels for particles migrating between PSO islands
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <sstream>
+
+#include "sc/alg/PsoMigration.h"
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+using namespace boost::interprocess;
+
+// ----------------------------------------------------------------------------
+// scPsoMemoryChannel
+// ----------------------------------------------------------------------------
+scPsoMemoryChannel::scPsoMemoryChannel(uint islandCount, uint capacity)
+{
+  m_capacity = capacity;
+  m_queue.resize(islandCount);
+}
+
+void scPsoMemoryChannel::send(uint islandIdx, const double *values, uint paramCount, double score)
+{
+#pragma omp critical(scPsoMemoryChannel)
+  {
+    std::deque<double> &queue = m_queue[islandIdx];
+
+    if (queue.size() >= static_cast<size_t>(m_capacity) * (paramCount + 1))
+      queue.erase(queue.begin(), queue.begin() + (paramCount + 1));
+
+    queue.push_back(score);
+    queue.insert(queue.end(), values, values + paramCount);
+  }
+}
+
+bool scPsoMemoryChannel::receive(uint islandIdx, double *values, uint paramCount, double &score)
+{
+  bool res;
+
+#pragma omp critical(scPsoMemoryChannel)
+  {
+    std::deque<double> &queue = m_queue[islandIdx];
+
+    res = (queue.size() >= paramCount + 1);
+    if (res) {
+      score = queue.front();
+      std::copy(queue.begin() + 1, queue.begin() + (paramCount + 1), values);
+      queue.erase(queue.begin(), queue.begin() + (paramCount + 1));
+    }
+  }
+
+  return res;
+}
+
+// ----------------------------------------------------------------------------
+// scPsoQueueChannel
+// ----------------------------------------------------------------------------
+scPsoQueueChannel::scPsoQueueChannel(const scString &name, uint islandCount, uint paramCount, uint capacity)
+{
+  m_paramCount = paramCount;
+  for(uint i=0; i != islandCount; i++)
+    m_queues.push_back(
+      new message_queue(open_or_create, getQueueName(name, i).c_str(), capacity, (paramCount + 1) * sizeof(double)));
+}
+
+scString scPsoQueueChannel::getQueueName(const scString &name, uint islandIdx)
+{
+  std::ostringstream out;
+  out << name << "_" << islandIdx;
+  return scString(out.str());
+}
+
+void scPsoQueueChannel::removeQueues(const scString &name, uint islandCount)
+{
+  for(uint i=0; i != islandCount; i++)
+    message_queue::remove(getQueueName(name, i).c_str());
+}
+
+void scPsoQueueChannel::send(uint islandIdx, const double *values, uint paramCount, double score)
+{
+  std::vector<double> message(m_paramCount + 1);
+
+  message[0] = score;
+  std::copy(values, values + std::min(paramCount, m_paramCount), message.begin() + 1);
+  m_queues[islandIdx].try_send(&message[0], message.size() * sizeof(double), 0);
+}
+
+bool scPsoQueueChannel::receive(uint islandIdx, double *values, uint paramCount, double &score)
+{
+  std::vector<double> message(m_paramCount + 1);
+  message_queue::size_type recvSize;
+  uint priority;
+
+  if (!m_queues[islandIdx].try_receive(&message[0], message.size() * sizeof(double), recvSize, priority))
+    return false;
+
+  score = message[0];
+  std::copy(message.begin() + 1, message.begin() + 1 + std::min(paramCount, m_paramCount), values);
+  return true;
+}
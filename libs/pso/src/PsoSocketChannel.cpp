@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoSocketChannel.cpp
+// Project:     scLib
+// Purpose:     PSO migration channel using Unix datagram sockets
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <sstream>
+#include <cstdio>
+
+#include "sc/alg/PsoSocketChannel.h"
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+using boost::asio::local::datagram_protocol;
+
+// ----------------------------------------------------------------------------
+// scPsoSocketChannel
+// ----------------------------------------------------------------------------
+// stale socket files of previous runs are removed before bind
+scPsoSocketChannel::scPsoSocketChannel(const scString &pathPrefix, uint firstIsland, uint localCount):
+  m_pathPrefix(pathPrefix), m_firstIsland(firstIsland), m_sendSocket(m_service)
+{
+  datagram_protocol::socket *socket;
+
+  m_sendSocket.open(datagram_protocol());
+  m_sendSocket.non_blocking(true);
+
+  for(uint i=0; i != localCount; i++)
+  {
+    std::remove(getSocketPath(firstIsland + i).c_str());
+    socket = new datagram_protocol::socket(m_service);
+    m_sockets.push_back(socket);
+    socket->open(datagram_protocol());
+    socket->bind(datagram_protocol::endpoint(getSocketPath(firstIsland + i)));
+    socket->non_blocking(true);
+  }
+}
+
+scPsoSocketChannel::~scPsoSocketChannel()
+{
+  for(uint i=0, epos = m_sockets.size(); i != epos; i++)
+  {
+    m_sockets[i].close();
+    std::remove(getSocketPath(m_firstIsland + i).c_str());
+  }
+}
+
+scString scPsoSocketChannel::getSocketPath(uint islandIdx) const
+{
+  std::ostringstream out;
+  out << m_pathPrefix << islandIdx;
+  return scString(out.str());
+}
+
+// target which is not running is ignored
+void scPsoSocketChannel::send(uint islandIdx, const double *values, uint paramCount, double score)
+{
+  std::vector<double> message(paramCount + 1);
+  const datagram_protocol::endpoint target(getSocketPath(islandIdx));
+  boost::system::error_code error;
+
+  message[0] = score;
+  std::copy(values, values + paramCount, message.begin() + 1);
+
+#pragma omp critical(scPsoSocketChannel)
+  m_sendSocket.send_to(boost::asio::buffer(message), target, 0, error);
+}
+
+// messages of different size are skipped, buffer is one value longer to detect them
+bool scPsoSocketChannel::receive(uint islandIdx, double *values, uint paramCount, double &score)
+{
+  std::vector<double> message(paramCount + 2);
+  datagram_protocol::socket &socket = m_sockets[islandIdx - m_firstIsland];
+  boost::system::error_code error;
+  size_t recvSize;
+
+  for(;;)
+  {
+    recvSize = socket.receive(boost::asio::buffer(message), 0, error);
+    if (error)
+      return false;
+    if (recvSize == (paramCount + 1) * sizeof(double))
+      break;
+  }
+
+  score = message[0];
+  std::copy(message.begin() + 1, message.begin() + (paramCount + 1), values);
+  return true;
+}
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
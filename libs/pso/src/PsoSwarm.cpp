@@ -0,0 +1,724 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoSwarm.cpp
+// Project:     scLib
+// Purpose:     PSO swarm state stored as dense arrays
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "base/rand.h"
+#include "base/bmath.h"
+
+#include "sc/alg/PsoSwarm.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scPsoSwarm
+// ----------------------------------------------------------------------------
+scPsoSwarm::scPsoSwarm()
+{
+  m_particleCount = 0;
+  m_paramCount = 0;
+  m_factor1 = PSO_DEF_FACTOR1;
+  m_factor2 = PSO_DEF_FACTOR2;
+  m_inertiaFactor = PSO_DEF_INERTIA_FACTOR;
+  m_historyLength = 0;
+  m_updateMode = pum_legacy;
+  m_threadCount = 1;
+  m_seed = 0;
+  m_seedEnabled = false;
+  m_randomSource = NULL;
+  m_runSeed = 0;
+  m_stepNo = 0;
+  m_velocityValid = false;
+  m_bestValid = false;
+  m_asyncUpdateCount = 0;
+  m_asyncTopologyValid = false;
+}
+
+void scPsoSwarm::resize(uint particleCount, uint paramCount)
+{
+  const size_t stateSize = static_cast<size_t>(particleCount) * paramCount;
+
+  m_particleCount = particleCount;
+  m_paramCount = paramCount;
+  m_minValue.resize(paramCount, 0.0);
+  m_maxValue.resize(paramCount, 0.0);
+  m_intParam.resize(paramCount, false);
+  m_position.assign(stateSize, 0.0);
+  m_velocity.assign(stateSize, 0.0);
+  m_bestPosition.assign(stateSize, 0.0);
+  m_score.assign(particleCount, 0.0);
+  m_bestScore.assign(particleCount, 0.0);
+  m_particleStep.assign(particleCount, 0);
+  reset();
+}
+
+uint scPsoSwarm::getParticleCount() const
+{
+  return m_particleCount;
+}
+
+uint scPsoSwarm::getParamCount() const
+{
+  return m_paramCount;
+}
+
+void scPsoSwarm::setParamRange(uint paramIdx, double minValue, double maxValue, bool isInt)
+{
+  m_minValue[paramIdx] = minValue;
+  m_maxValue[paramIdx] = maxValue;
+  m_intParam[paramIdx] = isInt;
+}
+
+double scPsoSwarm::getParamMin(uint paramIdx) const
+{
+  return m_minValue[paramIdx];
+}
+
+double scPsoSwarm::getParamMax(uint paramIdx) const
+{
+  return m_maxValue[paramIdx];
+}
+
+bool scPsoSwarm::isParamInt(uint paramIdx) const
+{
+  return m_intParam[paramIdx];
+}
+
+void scPsoSwarm::setFactors(double factor1, double factor2)
+{
+  m_factor1 = factor1;
+  m_factor2 = factor2;
+}
+
+void scPsoSwarm::setInertiaFactor(double value)
+{
+  m_inertiaFactor = value;
+}
+
+void scPsoSwarm::setHistoryLength(uint value)
+{
+  if (m_historyLength != value) {
+    m_historyLength = value;
+    m_historyPosition.clear();
+    m_historyScore.clear();
+  }
+}
+
+uint scPsoSwarm::getStepNo() const
+{
+  return m_stepNo;
+}
+
+scPsoTopology &scPsoSwarm::getTopology()
+{
+  return m_topology;
+}
+
+const scPsoTopology &scPsoSwarm::getTopology() const
+{
+  return m_topology;
+}
+
+void scPsoSwarm::setUpdateMode(scPsoUpdateMode value)
+{
+  m_updateMode = value;
+}
+
+void scPsoSwarm::setThreadCount(uint value)
+{
+  m_threadCount = value;
+}
+
+void scPsoSwarm::setSeed(uint64 value)
+{
+  m_seed = value;
+  m_seedEnabled = true;
+}
+
+void scPsoSwarm::setRandomGenerator(scRandomGenerator *value)
+{
+  m_randomSource = value;
+  m_topology.setRandomGenerator(value);
+}
+
+double *scPsoSwarm::getParamRow(std::vector<double> &values, uint paramIdx)
+{
+  return &values[static_cast<size_t>(paramIdx) * m_particleCount];
+}
+
+const double *scPsoSwarm::getParamRow(const std::vector<double> &values, uint paramIdx) const
+{
+  return &values[static_cast<size_t>(paramIdx) * m_particleCount];
+}
+
+double *scPsoSwarm::getPosition(uint paramIdx)
+{
+  return getParamRow(m_position, paramIdx);
+}
+
+const double *scPsoSwarm::getPosition(uint paramIdx) const
+{
+  return getParamRow(m_position, paramIdx);
+}
+
+const double *scPsoSwarm::getVelocity(uint paramIdx) const
+{
+  return getParamRow(m_velocity, paramIdx);
+}
+
+const double *scPsoSwarm::getBestPosition(uint paramIdx) const
+{
+  return getParamRow(m_bestPosition, paramIdx);
+}
+
+double *scPsoSwarm::getScore()
+{
+  return m_score.empty() ? NULL : &m_score[0];
+}
+
+const double *scPsoSwarm::getScore() const
+{
+  return m_score.empty() ? NULL : &m_score[0];
+}
+
+const double *scPsoSwarm::getBestScore() const
+{
+  return m_bestScore.empty() ? NULL : &m_bestScore[0];
+}
+
+void scPsoSwarm::setParticle(uint particleIdx, const double *values)
+{
+  for(uint j=0; j != m_paramCount; j++)
+    m_position[static_cast<size_t>(j) * m_particleCount + particleIdx] = values[j];
+}
+
+void scPsoSwarm::getParticle(uint particleIdx, double *values) const
+{
+  for(uint j=0; j != m_paramCount; j++)
+    values[j] = m_position[static_cast<size_t>(j) * m_particleCount + particleIdx];
+}
+
+void scPsoSwarm::reset()
+{
+  m_stepNo = 0;
+  m_velocityValid = false;
+  m_bestValid = false;
+  m_historyPosition.clear();
+  m_historyScore.clear();
+  std::fill(m_particleStep.begin(), m_particleStep.end(), 0);
+  m_asyncUpdateCount = 0;
+  m_asyncTopologyValid = false;
+}
+
+void scPsoSwarm::step()
+{
+  if (!m_particleCount)
+    return;
+
+  if (!m_velocityValid) {
+    if (m_updateMode == pum_block) {
+      prepareRunSeed();
+      initVelocityBlock();
+    } else {
+      initVelocity();
+    }
+  }
+
+  if (m_historyLength > 0)
+    updateBestFromHistory();
+  else
+    updateBest();
+
+  if (m_updateMode == pum_block) {
+    updateBlocks();
+  } else {
+    updateVelocity();
+    updatePosition();
+  }
+  m_stepNo++;
+  m_asyncTopologyValid = false;
+}
+
+// random velocity based on position, particle by particle
+void scPsoSwarm::initVelocity()
+{
+  size_t offset;
+  double v;
+
+  for(uint i=0; i != m_particleCount; i++)
+    for(uint j=0; j != m_paramCount; j++)
+    {
+      offset = static_cast<size_t>(j) * m_particleCount + i;
+      v = m_position[offset] * drawDouble(0.1, 1.0);
+      if (m_intParam[j])
+        v = static_cast<double>(round<int64>(v));
+      m_velocity[offset] = v;
+    }
+
+  m_velocityValid = true;
+}
+
+// no history - best is personal best
+void scPsoSwarm::updateBest()
+{
+  if (!m_bestValid) {
+    m_bestPosition = m_position;
+    m_bestScore = m_score;
+    m_bestValid = true;
+    return;
+  }
+
+  for(uint i=0; i != m_particleCount; i++)
+  {
+    if (m_score[i] > m_bestScore[i]) {
+      m_bestScore[i] = m_score[i];
+      for(uint j=0; j != m_paramCount; j++)
+        m_bestPosition[static_cast<size_t>(j) * m_particleCount + i] =
+          m_position[static_cast<size_t>(j) * m_particleCount + i];
+    }
+  }
+}
+
+// Best = best in last historyLength steps, first slot wins on equal score.
+// For each particle steps of window are kept in queue (ring of historyLength
+// items) ordered by step, with decreasing scores, so best is at front.
+// Step is removed from back when new step is better, from front when it
+// leaves window. Best position is copied only when best step changes.
+void scPsoSwarm::updateBestFromHistory()
+{
+  const size_t stateSize = m_position.size();
+  const uint slot = m_stepNo % m_historyLength;
+  const double *histPtr;
+  double *bestPtr;
+  uint *queue;
+  uint lastStep, bestStep, particleIdx;
+
+  if (m_historyScore.empty()) {
+    m_historyPosition.resize(stateSize * m_historyLength);
+    m_historyScore.resize(static_cast<size_t>(m_particleCount) * m_historyLength);
+    m_historyQueue.resize(static_cast<size_t>(m_particleCount) * m_historyLength);
+    m_queueBegin.assign(m_particleCount, 0);
+    m_queueSize.assign(m_particleCount, 0);
+    m_bestStep.assign(m_particleCount, UINT_MAX);
+    m_changedBest.reserve(m_particleCount);
+  }
+
+  std::copy(m_position.begin(), m_position.end(), m_historyPosition.begin() + stateSize * slot);
+  std::copy(m_score.begin(), m_score.end(), m_historyScore.begin() + static_cast<size_t>(m_particleCount) * slot);
+
+  m_changedBest.clear();
+  for(uint i=0; i != m_particleCount; i++)
+  {
+    queue = &m_historyQueue[static_cast<size_t>(i) * m_historyLength];
+
+    // step stored before in current slot leaves window
+    if (m_queueSize[i] && (queue[m_queueBegin[i]] + m_historyLength <= m_stepNo)) {
+      m_queueBegin[i] = (m_queueBegin[i] + 1) % m_historyLength;
+      m_queueSize[i]--;
+    }
+
+    while (m_queueSize[i]) {
+      lastStep = queue[(m_queueBegin[i] + m_queueSize[i] - 1) % m_historyLength];
+      if (!isBetterHistorySlot(i, slot, lastStep % m_historyLength))
+        break;
+      m_queueSize[i]--;
+    }
+
+    queue[(m_queueBegin[i] + m_queueSize[i]) % m_historyLength] = m_stepNo;
+    m_queueSize[i]++;
+
+    bestStep = queue[m_queueBegin[i]];
+    m_bestScore[i] = m_historyScore[static_cast<size_t>(m_particleCount) * (bestStep % m_historyLength) + i];
+    if (bestStep != m_bestStep[i]) {
+      m_bestStep[i] = bestStep;
+      m_changedBest.push_back(i);
+    }
+  }
+
+  // copy positions row by row, only for particles with new best
+  for(uint j=0; j != m_paramCount; j++)
+  {
+    bestPtr = getParamRow(m_bestPosition, j);
+    histPtr = &m_historyPosition[static_cast<size_t>(j) * m_particleCount];
+    for(uint c=0, epos = m_changedBest.size(); c != epos; c++)
+    {
+      particleIdx = m_changedBest[c];
+      bestPtr[particleIdx] = histPtr[stateSize * (m_bestStep[particleIdx] % m_historyLength) + particleIdx];
+    }
+  }
+
+  m_bestValid = true;
+}
+
+// score in newSlot is better than in oldSlot, on equal score lower slot is better
+bool scPsoSwarm::isBetterHistorySlot(uint particleIdx, uint newSlot, uint oldSlot) const
+{
+  const double newScore = m_historyScore[static_cast<size_t>(m_particleCount) * newSlot + particleIdx];
+  const double oldScore = m_historyScore[static_cast<size_t>(m_particleCount) * oldSlot + particleIdx];
+  return (newScore > oldScore) || ((newScore == oldScore) && (newSlot < oldSlot));
+}
+
+// With history current score is used, otherwise personal best.
+const double *scPsoSwarm::getLocalScores() const
+{
+  return (m_historyLength > 0) ? &m_score[0] : &m_bestScore[0];
+}
+
+// neighbour index for current step, must be called before findLocalBest()
+void scPsoSwarm::prepareTopology(const double *scores)
+{
+  m_topology.prepare(m_particleCount, m_stepNo);
+  m_topology.prepareBest(scores);
+}
+
+// Best of particle and its neighbours, first one wins on equal score.
+uint scPsoSwarm::findLocalBest(uint particleIdx) const
+{
+  return m_topology.findBest(particleIdx, getLocalScores());
+}
+
+// particle by particle, to keep order of random values
+void scPsoSwarm::updateVelocity()
+{
+  const std::vector<double> &localValues = (m_historyLength > 0) ? m_position : m_bestPosition;
+  size_t offset;
+  uint localBestIdx;
+  int64 intPos;
+  double currPos, oldVelocity, velocity;
+
+  prepareTopology(getLocalScores());
+
+  for(uint i=0; i != m_particleCount; i++)
+  {
+    localBestIdx = findLocalBest(i);
+    for(uint j=0; j != m_paramCount; j++)
+    {
+      offset = static_cast<size_t>(j) * m_particleCount;
+      currPos = m_position[offset + i];
+      oldVelocity = m_velocity[offset + i];
+      velocity = oldVelocity + m_factor1 * drawDouble(0.0, 1.0) * (m_bestPosition[offset + i] - currPos);
+
+      if (localBestIdx != i)
+        velocity += m_factor2 * drawDouble(0.0, 1.0) * (localValues[offset + localBestIdx] - currPos);
+
+      // update velocity with inertia
+      velocity = (m_inertiaFactor * oldVelocity) + (1.0 - m_inertiaFactor) * velocity;
+
+      // bounce from limits
+      currPos += velocity;
+      if (m_intParam[j]) {
+        intPos = round<int64>(currPos);
+        if (intPos < m_minValue[j])
+          velocity += (1.0 + drawDouble(0.0, 0.5)) * (m_minValue[j] - static_cast<double>(intPos));
+        else if (intPos > m_maxValue[j])
+          velocity -= (1.0 + drawDouble(0.0, 0.5)) * (static_cast<double>(intPos) - m_maxValue[j]);
+      } else {
+        if (currPos < m_minValue[j])
+          velocity += (1.0 + drawDouble(0.0, 0.5)) * (m_minValue[j] - currPos);
+        else if (currPos > m_maxValue[j])
+          velocity -= (1.0 + drawDouble(0.0, 0.5)) * (currPos - m_maxValue[j]);
+      }
+
+      m_velocity[offset + i] = velocity;
+    }
+  }
+}
+
+void scPsoSwarm::updatePosition()
+{
+  double *posPtr;
+  const double *velPtr;
+
+  for(uint j=0; j != m_paramCount; j++)
+  {
+    posPtr = getParamRow(m_position, j);
+    velPtr = getParamRow(m_velocity, j);
+    if (m_intParam[j]) {
+      for(uint i=0; i != m_particleCount; i++)
+        posPtr[i] = static_cast<double>(round<int>(posPtr[i] + velPtr[i]));
+    } else {
+      for(uint i=0; i != m_particleCount; i++)
+        posPtr[i] += velPtr[i];
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// block update
+// ----------------------------------------------------------------------------
+// round half away from zero, as round<int64>
+static inline double roundPsoValue(double value)
+{
+  return static_cast<double>(static_cast<int64>(value + ((value < 0.0) ? -0.5 : 0.5)));
+}
+
+uint scPsoSwarm::getWorkerCount() const
+{
+#ifdef _OPENMP
+  if (!m_threadCount)
+    return omp_get_max_threads();
+#endif
+  return m_threadCount ? m_threadCount : 1;
+}
+
+uint scPsoSwarm::getBlockCount() const
+{
+  return (m_particleCount + PSO_BLOCK_SIZE - 1) / PSO_BLOCK_SIZE;
+}
+
+// random stream of one block in one step, stepKey 0 is used by initialization
+uint64 scPsoSwarm::getBlockKey(uint stepKey, uint taskIdx) const
+{
+  return randomHash(randomHash(m_runSeed ^ (static_cast<uint64>(stepKey) << 32)) + taskIdx);
+}
+
+void scPsoSwarm::initVelocityBlock()
+{
+  const uint blockCount = getBlockCount();
+  const int taskCount = static_cast<int>(m_paramCount * blockCount);
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(taskCount > 1)
+  for(int t = 0; t < taskCount; t++)
+  {
+    const uint paramIdx = static_cast<uint>(t) / blockCount;
+    const uint beginPos = (static_cast<uint>(t) % blockCount) * PSO_BLOCK_SIZE;
+    const uint count = std::min<uint>(m_particleCount - beginPos, PSO_BLOCK_SIZE);
+    const size_t offset = static_cast<size_t>(paramIdx) * m_particleCount + beginPos;
+    const double *pos = &m_position[offset];
+    double *vel = &m_velocity[offset];
+    double randomValues[PSO_BLOCK_SIZE];
+    scRandomLaneGenerator generator(getBlockKey(0, static_cast<uint>(t)));
+
+    generator.fillDouble(randomValues, count);
+    for(uint i=0; i != count; i++)
+      vel[i] = pos[i] * (0.1 + 0.9 * randomValues[i]);
+    if (m_intParam[paramIdx])
+      for(uint i=0; i != count; i++)
+        vel[i] = roundPsoValue(vel[i]);
+  }
+
+  m_velocityValid = true;
+}
+
+void scPsoSwarm::prepareLocalBest()
+{
+  m_localBest.resize(m_particleCount);
+  m_socialFactor.resize(m_particleCount);
+  prepareTopology(getLocalScores());
+  for(uint i=0; i != m_particleCount; i++)
+  {
+    m_localBest[i] = findLocalBest(i);
+    m_socialFactor[i] = (m_localBest[i] != i) ? m_factor2 : 0.0;
+  }
+}
+
+void scPsoSwarm::updateBlocks()
+{
+  const uint blockCount = getBlockCount();
+  const int taskCount = static_cast<int>(m_paramCount * blockCount);
+  // with history neighbour current position is used, copy in history is not changed by update
+  const double *localValues = (m_historyLength > 0) ?
+    &m_historyPosition[m_position.size() * (m_stepNo % m_historyLength)] : &m_bestPosition[0];
+
+  prepareLocalBest();
+
+#pragma omp parallel for schedule(dynamic) num_threads(getWorkerCount()) if(taskCount > 1)
+  for(int t = 0; t < taskCount; t++)
+  {
+    const uint paramIdx = static_cast<uint>(t) / blockCount;
+    const uint beginPos = (static_cast<uint>(t) % blockCount) * PSO_BLOCK_SIZE;
+    double buffer[PSO_BLOCK_BUFFER_SIZE];
+
+    updateParamBlock(paramIdx, beginPos, std::min<uint>(m_particleCount, beginPos + PSO_BLOCK_SIZE),
+      localValues + static_cast<size_t>(paramIdx) * m_particleCount,
+      getBlockKey(m_stepNo + 1, static_cast<uint>(t)), buffer);
+  }
+}
+
+// Same formulas as updateVelocity() and updatePosition(), but one random value
+// is always drawn for each term. Loops are split into passes without branches
+// which can be vectorized: velocity, rounding of int params, reflection from limits.
+// buffer: PSO_BLOCK_BUFFER_SIZE values
+void scPsoSwarm::updateParamBlock(uint paramIdx, uint beginPos, uint endPos, const double *localValues,
+  uint64 blockKey, double *buffer)
+{
+  const uint count = endPos - beginPos;
+  const size_t offset = static_cast<size_t>(paramIdx) * m_particleCount + beginPos;
+  double *pos = &m_position[offset];
+  double *vel = &m_velocity[offset];
+  const double *best = &m_bestPosition[offset];
+  const uint *localBest = &m_localBest[beginPos];
+  const double *socialFactor = &m_socialFactor[beginPos];
+  const double *rand1 = buffer;
+  const double *rand2 = buffer + count;
+  const double *rand3 = buffer + 2 * count;
+  double *localPos = buffer + 3 * count;
+  double *newPos = buffer + 4 * count;
+  const double minValue = m_minValue[paramIdx];
+  const double maxValue = m_maxValue[paramIdx];
+  const double factor1 = m_factor1;
+  const double keepFactor = m_inertiaFactor;
+  const double mixFactor = 1.0 - m_inertiaFactor;
+  const bool isInt = m_intParam[paramIdx];
+  scRandomLaneGenerator generator(blockKey);
+  double x, v, below, above;
+
+  generator.fillDouble(buffer, 3 * count);
+
+  for(uint i=0; i != count; i++)
+    localPos[i] = localValues[localBest[i]];
+
+#pragma omp simd private(x, v)
+  for(uint i=0; i != count; i++)
+  {
+    x = pos[i];
+    v = vel[i] + factor1 * rand1[i] * (best[i] - x) + socialFactor[i] * rand2[i] * (localPos[i] - x);
+    v = keepFactor * vel[i] + mixFactor * v;
+    vel[i] = v;
+    newPos[i] = x + v;
+  }
+
+  if (isInt)
+    for(uint i=0; i != count; i++)
+      newPos[i] = roundPsoValue(newPos[i]);
+
+#pragma omp simd private(below, above)
+  for(uint i=0; i != count; i++)
+  {
+    // max(d, 0) = (d + |d|) / 2, without branch
+    below = minValue - newPos[i];
+    above = newPos[i] - maxValue;
+    vel[i] += (1.0 + 0.5 * rand3[i]) * 0.5 * ((below + std::fabs(below)) - (above + std::fabs(above)));
+    pos[i] += vel[i];
+  }
+
+  if (isInt)
+    for(uint i=0; i != count; i++)
+      pos[i] = roundPsoValue(pos[i]);
+}
+
+// ----------------------------------------------------------------------------
+// particle update
+// ----------------------------------------------------------------------------
+void scPsoSwarm::prepareRunSeed()
+{
+  if (m_seedEnabled)
+    m_runSeed = m_seed;
+  else if (m_randomSource)
+    m_runSeed = m_randomSource->next();
+  else
+    m_runSeed = randomHash(randomUInt64());
+}
+
+double scPsoSwarm::drawDouble(double minValue, double maxValue)
+{
+  if (m_randomSource)
+    return m_randomSource->randomDouble(minValue, maxValue);
+  return randomDouble(minValue, maxValue);
+}
+
+// Particles which were not updated yet have no best, so they are never
+// selected as neighbourhood best.
+// Neighbourhood best is prepared once per step (particleCount calls) and then
+// updated only for particle with improved best, so one call costs O(1).
+void scPsoSwarm::stepParticle(uint particleIdx)
+{
+  bool improved = false;
+
+  if (!m_velocityValid) {
+    prepareRunSeed();
+    initVelocityBlock();
+  }
+
+  if (!m_bestValid) {
+    m_bestPosition = m_position;
+    m_bestScore.assign(m_particleCount, -HUGE_VAL);
+    m_bestValid = true;
+  }
+
+  if (m_score[particleIdx] > m_bestScore[particleIdx]) {
+    m_bestScore[particleIdx] = m_score[particleIdx];
+    for(uint j=0; j != m_paramCount; j++)
+      m_bestPosition[static_cast<size_t>(j) * m_particleCount + particleIdx] =
+        m_position[static_cast<size_t>(j) * m_particleCount + particleIdx];
+    // best from history has to be copied again in next step()
+    if (!m_bestStep.empty())
+      m_bestStep[particleIdx] = UINT_MAX;
+    improved = true;
+  }
+
+  if (!m_asyncTopologyValid) {
+    prepareTopology(&m_bestScore[0]);
+    m_asyncTopologyValid = true;
+  } else if (improved) {
+    m_topology.updateBest(particleIdx, &m_bestScore[0]);
+  }
+
+  updateParticle(particleIdx);
+  m_particleStep[particleIdx]++;
+
+  // next step: ptt_random neighbours are refreshed by step number
+  if (++m_asyncUpdateCount >= m_particleCount) {
+    m_asyncUpdateCount = 0;
+    m_stepNo++;
+    m_asyncTopologyValid = false;
+  }
+}
+
+// random stream of one particle update, separate from block streams
+uint64 scPsoSwarm::getParticleKey(uint particleIdx) const
+{
+  return randomHash(randomHash(~m_runSeed ^ (static_cast<uint64>(m_particleStep[particleIdx] + 1) << 32)) + particleIdx);
+}
+
+// Same formulas as updateVelocity() and updatePosition() for one particle,
+// personal bests of neighbours are used, topology must be prepared.
+void scPsoSwarm::updateParticle(uint particleIdx)
+{
+  scRandomGenerator generator(getParticleKey(particleIdx));
+  size_t offset;
+  uint localBestIdx;
+  double currPos, oldVelocity, velocity;
+
+  localBestIdx = m_topology.findBest(particleIdx, &m_bestScore[0]);
+
+  for(uint j=0; j != m_paramCount; j++)
+  {
+    offset = static_cast<size_t>(j) * m_particleCount;
+    currPos = m_position[offset + particleIdx];
+    oldVelocity = m_velocity[offset + particleIdx];
+    velocity = oldVelocity + m_factor1 * generator.nextDouble() * (m_bestPosition[offset + particleIdx] - currPos);
+
+    if (localBestIdx != particleIdx)
+      velocity += m_factor2 * generator.nextDouble() * (m_bestPosition[offset + localBestIdx] - currPos);
+
+    velocity = (m_inertiaFactor * oldVelocity) + (1.0 - m_inertiaFactor) * velocity;
+
+    // bounce from limits
+    currPos += velocity;
+    if (m_intParam[j])
+      currPos = roundPsoValue(currPos);
+    if (currPos < m_minValue[j])
+      velocity += (1.0 + generator.randomDouble(0.0, 0.5)) * (m_minValue[j] - currPos);
+    else if (currPos > m_maxValue[j])
+      velocity -= (1.0 + generator.randomDouble(0.0, 0.5)) * (currPos - m_maxValue[j]);
+
+    m_velocity[offset + particleIdx] = velocity;
+    currPos = m_position[offset + particleIdx] + velocity;
+    m_position[offset + particleIdx] = m_intParam[j] ? roundPsoValue(currPos) : currPos;
+  }
+}
@@ -0,0 +1,227 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        PsoTopology.cpp
+// Project:     scLib
+// Purpose:     Neighbourhood of PSO particles
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/rand.h"
+
+#include "sc/alg/PsoTopology.h"
+
+#ifdef DEBUG_MEM
+#include "sc/DebugMem.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// scPsoTopology
+// ----------------------------------------------------------------------------
+scPsoTopology::scPsoTopology()
+{
+  m_type = ptt_ring;
+  m_neighbourCount = PSO_DEF_NEIGHBOUR_COUNT;
+  m_refreshInterval = PSO_DEF_TOPOLOGY_REFRESH;
+  m_seed = 0;
+  m_seedEnabled = false;
+  m_randomSource = NULL;
+  m_valid = false;
+  m_particleCount = 0;
+  m_generation = 0;
+  m_runSeed = 0;
+  m_globalBest = 0;
+}
+
+void scPsoTopology::setType(scPsoTopologyType value)
+{
+  m_type = value;
+  m_valid = false;
+}
+
+scPsoTopologyType scPsoTopology::getType() const
+{
+  return m_type;
+}
+
+void scPsoTopology::setNeighbourCount(uint value)
+{
+  m_neighbourCount = value;
+  m_valid = false;
+}
+
+void scPsoTopology::setRefreshInterval(uint value)
+{
+  m_refreshInterval = value;
+  m_valid = false;
+}
+
+void scPsoTopology::setSeed(uint64 value)
+{
+  m_seed = value;
+  m_seedEnabled = true;
+  m_valid = false;
+}
+
+void scPsoTopology::setRandomGenerator(scRandomGenerator *value)
+{
+  m_randomSource = value;
+  m_valid = false;
+}
+
+// index keeps its capacity, so rebuild does not allocate memory
+void scPsoTopology::prepare(uint particleCount, uint stepNo)
+{
+  const uint generation = ((m_type == ptt_random) && m_refreshInterval) ? stepNo / m_refreshInterval : 0;
+
+  if (m_valid && (particleCount == m_particleCount) && (generation == m_generation))
+    return;
+
+  if ((m_type == ptt_random) && (!m_valid || (particleCount != m_particleCount)))
+    m_runSeed = m_seedEnabled ? m_seed :
+      (m_randomSource ? m_randomSource->next() : randomHash(randomUInt64()));
+
+  m_particleCount = particleCount;
+  m_generation = generation;
+  m_globalBest = 0;
+  m_offset.clear();
+  m_index.clear();
+
+  if (particleCount > 0) {
+    switch (m_type) {
+      case ptt_von_neumann:
+        buildVonNeumann();
+        break;
+      case ptt_random:
+        buildRandom(generation);
+        break;
+      case ptt_global:
+        break;
+      default:
+        buildRing();
+    }
+  }
+
+  m_valid = true;
+}
+
+void scPsoTopology::prepareBest(const double *scores)
+{
+  if (m_type != ptt_global)
+    return;
+
+  m_globalBest = 0;
+  for(uint i=1; i < m_particleCount; i++)
+    if (scores[i] > scores[m_globalBest])
+      m_globalBest = i;
+}
+
+// on equal score lower index wins, as in prepareBest()
+void scPsoTopology::updateBest(uint particleIdx, const double *scores)
+{
+  if (m_type != ptt_global)
+    return;
+
+  if ((scores[particleIdx] > scores[m_globalBest]) ||
+      ((scores[particleIdx] == scores[m_globalBest]) && (particleIdx < m_globalBest)))
+    m_globalBest = particleIdx;
+}
+
+uint scPsoTopology::findBest(uint particleIdx, const double *scores) const
+{
+  if (m_type == ptt_global)
+    return (scores[m_globalBest] > scores[particleIdx]) ? m_globalBest : particleIdx;
+
+  const uint *neighbourPtr = &m_index[m_offset[particleIdx]];
+  const uint *endPtr = &m_index[0] + m_offset[particleIdx + 1];
+  uint res = *neighbourPtr;
+
+  for(++neighbourPtr; neighbourPtr != endPtr; ++neighbourPtr)
+    if (scores[*neighbourPtr] > scores[res])
+      res = *neighbourPtr;
+
+  return res;
+}
+
+// for ptt_global: particle count, no list
+uint scPsoTopology::getNeighbourCount(uint particleIdx) const
+{
+  if (m_type == ptt_global)
+    return m_particleCount;
+  return m_offset[particleIdx + 1] - m_offset[particleIdx];
+}
+
+const uint *scPsoTopology::getNeighbours(uint particleIdx) const
+{
+  if (m_type == ptt_global)
+    return NULL;
+  return &m_index[m_offset[particleIdx]];
+}
+
+// neighbour is added to list of last particle if not already there
+void scPsoTopology::addUniqueNeighbour(uint neighbourIdx)
+{
+  for(uint p=m_offset.back(), epos = m_index.size(); p != epos; p++)
+    if (m_index[p] == neighbourIdx)
+      return;
+  m_index.push_back(neighbourIdx);
+}
+
+void scPsoTopology::buildRing()
+{
+  const uint n = m_particleCount;
+  const uint sideCount = std::min<uint>(m_neighbourCount, n / 2);
+
+  m_offset.push_back(0);
+  for(uint i=0; i != n; i++)
+  {
+    m_index.push_back(i);
+    for(uint d=1; d <= sideCount; d++)
+    {
+      addUniqueNeighbour((i + n - d) % n);
+      addUniqueNeighbour((i + d) % n);
+    }
+    m_offset.push_back(m_index.size());
+  }
+}
+
+void scPsoTopology::buildVonNeumann()
+{
+  const uint n = m_particleCount;
+  const uint colCount = std::max<uint>(1, static_cast<uint>(std::floor(std::sqrt(static_cast<double>(n)) + 0.5)));
+
+  m_offset.push_back(0);
+  for(uint i=0; i != n; i++)
+  {
+    m_index.push_back(i);
+    addUniqueNeighbour((i + n - 1) % n);
+    addUniqueNeighbour((i + 1) % n);
+    addUniqueNeighbour((i + n - colCount % n) % n);
+    addUniqueNeighbour((i + colCount) % n);
+    m_offset.push_back(m_index.size());
+  }
+}
+
+// neighbours of each generation come from own random stream
+void scPsoTopology::buildRandom(uint generation)
+{
+  const uint n = m_particleCount;
+  const uint count = std::min<uint>(m_neighbourCount, n - 1);
+  scRandomGenerator generator(randomHash(m_runSeed ^ (static_cast<uint64>(generation + 1) << 32)));
+  uint listSize;
+
+  m_offset.push_back(0);
+  for(uint i=0; i != n; i++)
+  {
+    m_index.push_back(i);
+    listSize = 1;
+    while (listSize <= count) {
+      addUniqueNeighbour(generator.randomUInt(0, n - 1));
+      listSize = m_index.size() - m_offset.back();
+    }
+    m_offset.push_back(m_index.size());
+  }
+}
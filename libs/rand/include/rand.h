@@ -17,11 +17,20 @@
 /// \file rand.h
 ///
 /// Random numbers support using Mersene-Twister generator.
-/// Note: this module is NOT thread-safe.
+/// Global functions (randomDouble() etc.) share one generator and each draw
+/// is serialised by omp critical, so they can be called from many threads,
+/// but sequence seen by a thread depends on other threads.
+/// For per-instance, seedable generator use scRandomGenerator - algorithms
+/// accept it with setRandomGenerator(), one stream per thread can be
+/// created with splitRandomStreams(). Instances are independent and need
+/// no locking, but a single instance must not be shared between threads.
 
 // ----------------------------------------------------------------------------
 // Headers
 // ----------------------------------------------------------------------------
+//std
+#include <vector>
+
 #include "base/btypes.h"
 #include "base/string.h"
 
@@ -36,10 +45,54 @@
 // ----------------------------------------------------------------------------
 // Constants
 // ----------------------------------------------------------------------------
+// number of streams in scRandomLaneGenerator
+const uint RANDOM_LANE_COUNT = 4;
+// number of uint64 values in state of scRandomGenerator
+const uint RANDOM_STATE_SIZE = 4;
 
 // ----------------------------------------------------------------------------
 // Class definitions
 // ----------------------------------------------------------------------------
+/// Seedable generator (xoshiro256**), each object has own state.
+/// Object is not synchronized - use one object per thread.
+class scRandomGenerator {
+public:
+  scRandomGenerator();
+  explicit scRandomGenerator(uint64 seedValue);
+  void seed(uint64 value);
+  /// next raw 64-bit value
+  uint64 next();
+  /// value in range [0, 1)
+  double nextDouble();
+  double randomDouble(double a_min, double a_max);
+  uint randomUInt(uint a_min, uint a_max);
+  /// advance by 2^128 values, used to create non-overlapping streams
+  void jump();
+  /// advance by 2^192 values
+  void longJump();
+  /// copy RANDOM_STATE_SIZE values of state, for saving and restoring generator
+  void getState(uint64 *output) const;
+  void setState(const uint64 *input);
+protected:
+  void jumpBy(const uint64 *poly);
+protected:
+  uint64 m_state[RANDOM_STATE_SIZE];
+};
+
+/// RANDOM_LANE_COUNT xoshiro256** generators advanced together, state is
+/// stored lane-wise so loops over lanes can be vectorized by compiler.
+/// Used to fill buffers of random values.
+class scRandomLaneGenerator {
+public:
+  scRandomLaneGenerator();
+  explicit scRandomLaneGenerator(uint64 seedValue);
+  void seed(uint64 value);
+  /// Fill output with values in range [0, 1) (52 random bits),
+  /// value k is produced by lane k % RANDOM_LANE_COUNT.
+  void fillDouble(double *output, uint count);
+protected:
+  uint64 m_state[4][RANDOM_LANE_COUNT];
+};
 
 // ----------------------------------------------------------------------------
 // Function declarations
@@ -49,8 +102,18 @@ double randomDouble(double a_min, double a_max);
 xdouble randomXDouble(xdouble a_min, xdouble a_max);
 int randomInt(int a_min, int a_max);
 uint randomUInt(uint a_min, uint a_max);
+/// full-range 64-bit value, e.g. seed for scRandomGenerator
+uint64 randomUInt64();
 bool randomBool();
 bool randomFlip(double aProb);
 void randomString(const dtpString &alphabet, uint a_size, dtpString &output);
 
+/// Fill output with count independent streams: stream k is base after k jumps.
+/// Each thread can then use own stream without locking.
+void splitRandomStreams(const scRandomGenerator &base, uint count, std::vector<scRandomGenerator> &output);
+
+/// Stateless (counter-based) random value: mixes bits of input (SplitMix64).
+/// Thread-safe, the same input always gives the same output.
+uint64 randomHash(uint64 value);
+
 #endif // _SCRAND_H__
@@ -18,6 +18,7 @@
 
 // std
 #include <ctime>
+#include <cstring>
 
 // boost
 #include "boost/random.hpp"
@@ -124,6 +125,16 @@ uint randomUInt(uint a_min, uint a_max)
   return nextVal;
 }
 
+// randomUInt(0, UINT_MAX) is not usable (range size wraps to 0),
+// so value is built from 16-bit parts
+uint64 randomUInt64()
+{
+  uint64 res = 0;
+  for(uint i=0; i != 4; i++)
+    res = (res << 16) | randomUInt(0, 0xFFFF);
+  return res;
+}
+
 bool randomBool()
 {
   return (randomDouble(0.0, 1.0) < 0.5);
@@ -156,3 +167,197 @@ void randomString(const dtpString &alphabet, uint a_size, dtpString &output)
   }
   output = outValue;
 }
+
+uint64 randomHash(uint64 value)
+{
+  uint64 z = value + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// ----------------------------------------------------------------------------
+// scRandomGenerator
+// ----------------------------------------------------------------------------
+static inline uint64 rotateLeft64(uint64 value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+scRandomGenerator::scRandomGenerator()
+{
+  seed(0);
+}
+
+scRandomGenerator::scRandomGenerator(uint64 seedValue)
+{
+  seed(seedValue);
+}
+
+void scRandomGenerator::seed(uint64 value)
+{
+  // state initialized with SplitMix64 sequence
+  for(uint i=0; i != 4; i++)
+    m_state[i] = randomHash(value + i * 0x9E3779B97F4A7C15ULL);
+}
+
+uint64 scRandomGenerator::next()
+{
+  const uint64 res = rotateLeft64(m_state[1] * 5, 7) * 9;
+  const uint64 t = m_state[1] << 17;
+
+  m_state[2] ^= m_state[0];
+  m_state[3] ^= m_state[1];
+  m_state[1] ^= m_state[2];
+  m_state[0] ^= m_state[3];
+  m_state[2] ^= t;
+  m_state[3] = rotateLeft64(m_state[3], 45);
+
+  return res;
+}
+
+double scRandomGenerator::nextDouble()
+{
+  // 53 random bits
+  return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double scRandomGenerator::randomDouble(double a_min, double a_max)
+{
+  return (nextDouble()*(a_max-a_min))+a_min;
+}
+
+uint scRandomGenerator::randomUInt(uint a_min, uint a_max)
+{
+  uint64 range = static_cast<uint64>(a_max - a_min) + 1;
+  return a_min + static_cast<uint>(((next() >> 32) * range) >> 32);
+}
+
+// jump polynomials of xoshiro256**
+void scRandomGenerator::jump()
+{
+  static const uint64 poly[RANDOM_STATE_SIZE] = {
+    0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+  jumpBy(poly);
+}
+
+void scRandomGenerator::longJump()
+{
+  static const uint64 poly[RANDOM_STATE_SIZE] = {
+    0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+  jumpBy(poly);
+}
+
+void scRandomGenerator::jumpBy(const uint64 *poly)
+{
+  uint64 res[RANDOM_STATE_SIZE] = {0, 0, 0, 0};
+
+  for(uint i=0; i != RANDOM_STATE_SIZE; i++)
+    for(uint b=0; b != 64; b++)
+    {
+      if (poly[i] & (static_cast<uint64>(1) << b))
+        for(uint k=0; k != RANDOM_STATE_SIZE; k++)
+          res[k] ^= m_state[k];
+      next();
+    }
+
+  memcpy(m_state, res, sizeof(m_state));
+}
+
+void scRandomGenerator::getState(uint64 *output) const
+{
+  memcpy(output, m_state, sizeof(m_state));
+}
+
+void scRandomGenerator::setState(const uint64 *input)
+{
+  memcpy(m_state, input, sizeof(m_state));
+}
+
+void splitRandomStreams(const scRandomGenerator &base, uint count, std::vector<scRandomGenerator> &output)
+{
+  output.assign(count, base);
+  for(uint k=1; k < count; k++)
+  {
+    output[k] = output[k - 1];
+    output[k].jump();
+  }
+}
+
+// ----------------------------------------------------------------------------
+// scRandomLaneGenerator
+// ----------------------------------------------------------------------------
+scRandomLaneGenerator::scRandomLaneGenerator()
+{
+  seed(0);
+}
+
+scRandomLaneGenerator::scRandomLaneGenerator(uint64 seedValue)
+{
+  seed(seedValue);
+}
+
+void scRandomLaneGenerator::seed(uint64 value)
+{
+  // each lane seeded as scRandomGenerator with hash of seed and lane number
+  for(uint l=0; l != RANDOM_LANE_COUNT; l++)
+  {
+    const uint64 laneSeed = randomHash(value ^ (static_cast<uint64>(l + 1) << 56));
+    for(uint i=0; i != 4; i++)
+      m_state[i][l] = randomHash(laneSeed + i * 0x9E3779B97F4A7C15ULL);
+  }
+}
+
+// one 64-bit value from each lane
+static inline void nextRandomLaneGroup(uint64 state[4][RANDOM_LANE_COUNT], uint64 *output)
+{
+  uint64 t;
+
+  for(uint l=0; l != RANDOM_LANE_COUNT; l++)
+  {
+    output[l] = rotateLeft64(state[1][l] * 5, 7) * 9;
+    t = state[1][l] << 17;
+    state[2][l] ^= state[0][l];
+    state[3][l] ^= state[1][l];
+    state[1][l] ^= state[2][l];
+    state[0][l] ^= state[3][l];
+    state[2][l] ^= t;
+    state[3][l] = rotateLeft64(state[3][l], 45);
+  }
+}
+
+// value in range [0, 1) from 52 high bits, built from bits of double in range [1, 2)
+static inline void convertRandomLaneGroup(uint64 *bits, double *output)
+{
+  for(uint l=0; l != RANDOM_LANE_COUNT; l++)
+    bits[l] = (bits[l] >> 12) | 0x3FF0000000000000ULL;
+  memcpy(output, bits, sizeof(uint64) * RANDOM_LANE_COUNT);
+  for(uint l=0; l != RANDOM_LANE_COUNT; l++)
+    output[l] -= 1.0;
+}
+
+// state is kept in local copy, so it is not reloaded after each write to output
+void scRandomLaneGenerator::fillDouble(double *output, uint count)
+{
+  uint64 state[4][RANDOM_LANE_COUNT];
+  uint64 bits[RANDOM_LANE_COUNT];
+  double group[RANDOM_LANE_COUNT];
+  uint pos = 0;
+
+  memcpy(state, m_state, sizeof(state));
+
+  for(; pos + RANDOM_LANE_COUNT <= count; pos += RANDOM_LANE_COUNT)
+  {
+    nextRandomLaneGroup(state, bits);
+    convertRandomLaneGroup(bits, output + pos);
+  }
+
+  if (pos < count) {
+    nextRandomLaneGroup(state, bits);
+    convertRandomLaneGroup(bits, group);
+    for(uint l=0; pos < count; l++, pos++)
+      output[pos] = group[l];
+  }
+
+  memcpy(m_state, state, sizeof(state));
+}
@@ -0,0 +1,72 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        moving_average.h
+// Project:     scLib
+// Purpose:     Moving average calculated with sliding window sum
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SCMOVINGAVERAGE_H__
+#define _SCMOVINGAVERAGE_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file moving_average.h
+\brief Moving average in O(n)
+
+Window sum is updated when window moves by one sample (value leaving window
+is subtracted, value entering is added), so average of each window costs
+O(1) instead of O(blockSize). Sum is compensated (Neumaier) and calculated
+again from window values every resync interval, so error does not grow with
+length of series.
+
+Windows near end of input are shortened, as in calcMa(): average of values
+from offset to end of input, 0 for empty window.
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include "base/btypes.h"
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+// minimal number of moves between exact sums of window
+const uint MOVING_AVG_MIN_RESYNC = 1024;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+class scMovingAverage {
+public:
+  /// start with window at offset 0, input is not copied
+  scMovingAverage(const double *input, uint inputSize, uint blockSize);
+  /// average of current window
+  double getAverage() const;
+  uint getOffset() const;
+  /// move window by one sample
+  void next();
+protected:
+  void add(double value);
+  void resync();
+protected:
+  const double *m_input;
+  uint m_inputSize;
+  uint m_blockSize;
+  uint m_offset;
+  uint m_resyncInterval;
+  uint m_moveCount;
+  double m_sum;
+  double m_correction;
+};
+
+// ----------------------------------------------------------------------------
+// Global functions
+// ----------------------------------------------------------------------------
+/// averages of windows starting at 0..windowCount-1
+void calcMovingAverage(const double *input, uint inputSize, uint blockSize, uint windowCount, double *output);
+
+#endif // _SCMOVINGAVERAGE_H__
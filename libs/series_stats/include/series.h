@@ -83,6 +83,9 @@ double calcMaDiff(const scVectorOfDouble &yVect, const scVectorOfDouble &fxVect,
 double calcMa(const scVectorOfDouble &input, uint blockSize, uint offset);
 // calculate MA vector
 void calcMaVector(const scVectorOfDouble &input, uint blockSize, scVectorOfDouble &output);
+// check O(n) calcMaVector and calcMaDiff against sums of each window (calcMa),
+// returns max difference relative to max(|reference|, 1); vectors must have the same size
+double checkMaAgreement(const scVectorOfDouble &yVect, const scVectorOfDouble &fxVect, uint blockSize);
 
 // calculate frequence vector for objective
 void calcFreqVector(const scVectorOfDouble &valueVect, scVectorOfDouble &output);
@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        series_window.h
+// Project:     scLib
+// Purpose:     Window statistics of series answered from prefix tables
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SCSERIESWINDOW_H__
+#define _SCSERIESWINDOW_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file series_window.h
+\brief Window statistics of series in O(1)
+
+Tables are prepared once for whole series in O(n), then each window
+<beginPos, endPos) is answered in O(1) with the same result as
+countExtremeValues(), sumExtremeDiffs() and sumIncreases() on this window.
+
+Whether sample is extreme value depends only on its two neighbours, so
+extremes of window are extremes of series between beginPos + 1 and
+endPos - 2. Sums are taken as differences of prefix sums; the only window
+specific part is distance from first sample of window to first extreme.
+
+Prefix sums are compensated (Neumaier), so window sums agree with direct
+summation to rounding also for long series. Truncation of sum to int can
+differ for such rounding, so truncExtremeDiffs() falls back to direct
+summation of the window when sum is within rounding error of an integer
+(not needed for integer samples, their sums are exact).
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include "sc/alg/series.h"
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+class scSeriesWindowStats {
+public:
+  /// prepare tables, input has to live as long as this object
+  scSeriesWindowStats(const scVectorOfDouble &input);
+  /// number of minimas & maximas in window
+  uint countExtremeValues(int beginPos, int endPos) const;
+  /// sum of distances between consecutive extreme values in window
+  double sumExtremeDiffs(int beginPos, int endPos) const;
+  /// sumExtremeDiffs() truncated to int, always the same as truncated direct sum
+  int truncExtremeDiffs(int beginPos, int endPos) const;
+  /// sum of positive differences between consecutive samples in window
+  double sumIncreases(int beginPos, int endPos) const;
+protected:
+  void prepare();
+protected:
+  const scVectorOfDouble &m_input;
+  // number of extreme values before position, size n + 1
+  std::vector<uint> m_extremeCount;
+  // positions of extreme values
+  std::vector<uint> m_extremePos;
+  // sum of distances between extremes 0..k, compensated
+  scVectorOfDouble m_extremeDiffSum;
+  scVectorOfDouble m_extremeDiffCorr;
+  // sum of increases before position, size n + 1, compensated
+  scVectorOfDouble m_increaseSum;
+  scVectorOfDouble m_increaseCorr;
+  // all samples are integers small enough for exact sums
+  bool m_exactSums;
+};
+
+#endif // _SCSERIESWINDOW_H__
@@ -0,0 +1,90 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        moving_average.cpp
+// Project:     scLib
+// Purpose:     Moving average calculated with sliding window sum
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#define NOMINMAX
+#include <algorithm>
+#include <cmath>
+
+#include "sc/alg/moving_average.h"
+
+// ----------------------------------------------------------------------------
+// scMovingAverage
+// ----------------------------------------------------------------------------
+// exact sum of window every blockSize moves keeps cost O(1) per move
+scMovingAverage::scMovingAverage(const double *input, uint inputSize, uint blockSize)
+{
+  m_input = input;
+  m_inputSize = inputSize;
+  m_blockSize = blockSize;
+  m_offset = 0;
+  m_resyncInterval = std::max<uint>(blockSize, MOVING_AVG_MIN_RESYNC);
+  resync();
+}
+
+double scMovingAverage::getAverage() const
+{
+  const uint endPos = std::min<uint>(m_inputSize, m_offset + m_blockSize);
+
+  if (endPos <= m_offset)
+    return 0.0;
+  return (m_sum + m_correction) / double(endPos - m_offset);
+}
+
+uint scMovingAverage::getOffset() const
+{
+  return m_offset;
+}
+
+void scMovingAverage::next()
+{
+  if (++m_moveCount >= m_resyncInterval) {
+    m_offset++;
+    resync();
+    return;
+  }
+
+  if (m_offset < m_inputSize)
+    add(-m_input[m_offset]);
+  if (m_offset + m_blockSize < m_inputSize)
+    add(m_input[m_offset + m_blockSize]);
+  m_offset++;
+}
+
+// Neumaier summation: lost low-order bits are kept in correction
+void scMovingAverage::add(double value)
+{
+  const double sum = m_sum + value;
+
+  if (fabs(m_sum) >= fabs(value))
+    m_correction += (m_sum - sum) + value;
+  else
+    m_correction += (value - sum) + m_sum;
+  m_sum = sum;
+}
+
+void scMovingAverage::resync()
+{
+  const uint endPos = std::min<uint>(m_inputSize, m_offset + m_blockSize);
+
+  m_sum = m_correction = 0.0;
+  m_moveCount = 0;
+  for(uint i = m_offset; i < endPos; i++)
+    add(m_input[i]);
+}
+
+// ----------------------------------------------------------------------------
+// Global functions
+// ----------------------------------------------------------------------------
+void calcMovingAverage(const double *input, uint inputSize, uint blockSize, uint windowCount, double *output)
+{
+  scMovingAverage window(input, inputSize, blockSize);
+
+  for(uint i = 0; i != windowCount; i++, window.next())
+    output[i] = window.getAverage();
+}
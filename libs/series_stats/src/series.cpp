@@ -15,6 +15,8 @@
 #include "base/algorithm.h"
 
 #include "sc/alg/series.h"
+#include "sc/alg/moving_average.h"
+#include "sc/alg/series_window.h"
 #include "sc/utils.h"
 #include "sc/vect.h"
 
@@ -261,13 +263,23 @@ double calcFadingMaDiff(const scVectorOfDouble &yVect, const scVectorOfDouble &f
   return outSum;
 }
 
+// both averages are moved along series, so cost does not depend on blockSize
 double calcMaDiff(const scVectorOfDouble &yVect, const scVectorOfDouble &fxVect, uint blockSize)
 {
   double outSum = 0.0;
   double partDiff;
+
+  if (blockSize > yVect.size())
+    return outSum;
+
+  scMovingAverage yMa(yVect.empty() ? NULL : &yVect[0], yVect.size(), blockSize);
+  scMovingAverage fxMa(fxVect.empty() ? NULL : &fxVect[0], fxVect.size(), blockSize);
+
   for(uint i = 0, epos = yVect.size() - blockSize + 1; i < epos; i++) {
-    partDiff = 1.0 + fabs(calcMa(yVect, blockSize, i) - calcMa(fxVect, blockSize, i));    
+    partDiff = 1.0 + fabs(yMa.getAverage() - fxMa.getAverage());
     outSum += (partDiff * partDiff);
+    yMa.next();
+    fxMa.next();
   }
   return outSum;
 }
@@ -296,40 +308,103 @@ void calcMaVector(const scVectorOfDouble &input, uint blockSize, scVectorOfDoubl
     targetSize = 0;  
 
   output.resize(targetSize);
-  
-  for(uint i = 0, epos = output.size(); i < epos; i++) {
-    output[i] = calcMa(input, blockSize, i);    
+
+  if (targetSize)
+    calcMovingAverage(input.empty() ? NULL : &input[0], input.size(), blockSize, targetSize, &output[0]);
+}
+
+static double calcRelativeDiff(double value, double reference)
+{
+  return fabs(value - reference) / std::max(fabs(reference), 1.0);
+}
+
+// reference is calculated in O(n*blockSize)
+double checkMaAgreement(const scVectorOfDouble &yVect, const scVectorOfDouble &fxVect, uint blockSize)
+{
+  scVectorOfDouble maVect;
+  double res = 0.0;
+  double refDiffSum = 0.0;
+  double refMa, partDiff;
+
+  assert(yVect.size() == fxVect.size());
+  calcMaVector(yVect, blockSize, maVect);
+
+  for(uint i = 0, epos = maVect.size(); i < epos; i++) {
+    refMa = calcMa(yVect, blockSize, i);
+    res = std::max(res, calcRelativeDiff(maVect[i], refMa));
+    partDiff = 1.0 + fabs(refMa - calcMa(fxVect, blockSize, i));
+    refDiffSum += (partDiff * partDiff);
   }
+
+  return std::max(res, calcRelativeDiff(calcMaDiff(yVect, fxVect, blockSize), refDiffSum));
 }
 
-// calculate frequence vector for objective
-void calcFreqVector(const scVectorOfDouble &valueVect, scVectorOfDouble &output)
+// window statistics used by multi-scale vectors
+class scExtremeCountStat {
+public:
+  scExtremeCountStat(const scSeriesWindowStats &stats): m_stats(stats) {}
+  double operator()(int beginPos, int endPos) const {
+    return static_cast<double>(m_stats.countExtremeValues(beginPos, endPos));
+  }
+protected:
+  const scSeriesWindowStats &m_stats;
+};
+
+// amplitude is truncated to int
+class scExtremeDiffStat {
+public:
+  scExtremeDiffStat(const scSeriesWindowStats &stats): m_stats(stats) {}
+  double operator()(int beginPos, int endPos) const {
+    return static_cast<double>(m_stats.truncExtremeDiffs(beginPos, endPos));
+  }
+protected:
+  const scSeriesWindowStats &m_stats;
+};
+
+class scIncreaseStat {
+public:
+  scIncreaseStat(const scSeriesWindowStats &stats): m_stats(stats) {}
+  double operator()(int beginPos, int endPos) const {
+    return m_stats.sumIncreases(beginPos, endPos);
+  }
+protected:
+  const scSeriesWindowStats &m_stats;
+};
+
+// For each point sum statistic of windows around it with gap 1, 2, 4...
+// weighted by 1/2, 1/4, 1/8...
+// Statistic is O(1), so whole vector costs O(n log n).
+template<typename WindowStat>
+static void calcMultiScaleVector(uint inputSize, const WindowStat &stat, scVectorOfDouble &output)
 {
-  output.resize(valueVect.size());
+  output.resize(inputSize);
   int minIdx, maxIdx, gap;
-  int extremeCount;
-  double freqTotal, freqGap;
-  double step;
-  for(int i=0, epos = valueVect.size(); i != epos; i++)
+  double valTotal, weight;
+  for(int i=0, epos = inputSize; i != epos; i++)
   {
     gap = 1;
-    step = 1.0;
-    freqTotal = 0.0;
-    
+    weight = 0.5;
+    valTotal = 0.0;
+
     while(((i + gap) < epos) || (i - gap) >= 0)
     {
       minIdx = std::max(i - gap, 0);
       maxIdx = std::min(i + gap, epos - 1);
-      extremeCount = countExtremeValues(valueVect, minIdx, maxIdx + 1);
-      freqGap = static_cast<double>(extremeCount)*(1.0/pow(2.0, step));
-      freqTotal += freqGap;
+      valTotal += stat(minIdx, maxIdx + 1)*weight;
       gap *= 2;
-      step += 1.0; 
+      weight *= 0.5;
     }
-    output[i] = freqTotal;
+    output[i] = valTotal;
   }
 }
 
+// calculate frequence vector for objective
+void calcFreqVector(const scVectorOfDouble &valueVect, scVectorOfDouble &output)
+{
+  scSeriesWindowStats stats(valueVect);
+  calcMultiScaleVector(valueVect.size(), scExtremeCountStat(stats), output);
+}
+
 // calculate frequence objective
 double calcFreqDiff(const scVectorOfDouble &yVect, const scVectorOfDouble &fxVect)
 {
@@ -355,29 +430,8 @@ double calcFreqDiffPrepared(const scVectorOfDouble &yVectFreq, const scVectorOfD
 // calculate amplitude vector for objective
 void calcAmplitudeVector(const scVectorOfDouble &valueVect, scVectorOfDouble &output)
 {
-  output.resize(valueVect.size());
-  int minIdx, maxIdx, gap;
-  int extremeCount;
-  double freqTotal, freqGap;
-  double step;
-  for(int i=0, epos = valueVect.size(); i != epos; i++)
-  {
-    gap = 1;
-    step = 1.0;
-    freqTotal = 0.0;
-    
-    while(((i + gap) < epos) || (i - gap) >= 0)
-    {
-      minIdx = std::max(i - gap, 0);
-      maxIdx = std::min(i + gap, epos - 1);
-      extremeCount = static_cast<int>(sumExtremeDiffs(valueVect, minIdx, maxIdx + 1));
-      freqGap = static_cast<double>(extremeCount)*(1.0/pow(2.0, step));
-      freqTotal += freqGap;
-      gap *= 2;
-      step += 1.0; 
-    }
-    output[i] = freqTotal;
-  }
+  scSeriesWindowStats stats(valueVect);
+  calcMultiScaleVector(valueVect.size(), scExtremeDiffStat(stats), output);
 }
 
 // calculate frequence objective
@@ -404,28 +458,8 @@ double calcAmplitudeDiffPrepared(const scVectorOfDouble &yVectAmpli, const scVec
 
 void calcIncreasesVector(const scVectorOfDouble &valueVect, scVectorOfDouble &output)
 {
-  output.resize(valueVect.size());
-  int minIdx, maxIdx, gap;
-  double valTotal, valGap;
-  double step, incSum;
-  for(int i=0, epos = valueVect.size(); i != epos; i++)
-  {
-    gap = 1;
-    step = 1.0;
-    valTotal = 0.0;
-    
-    while(((i + gap) < epos) || (i - gap) >= 0)
-    {
-      minIdx = std::max(i - gap, 0);
-      maxIdx = std::min(i + gap, epos - 1);
-      incSum = sumIncreases(valueVect, minIdx, maxIdx + 1);
-      valGap = incSum*(1.0/pow(2.0, step));      
-      valTotal += valGap;
-      gap *= 2;
-      step += 1.0; 
-    }
-    output[i] = valTotal;
-  }
+  scSeriesWindowStats stats(valueVect);
+  calcMultiScaleVector(valueVect.size(), scIncreaseStat(stats), output);
 }
 
 // calculate increases objective
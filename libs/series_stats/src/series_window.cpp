@@ -0,0 +1,140 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        series_window.cpp
+// Project:     scLib
+// Purpose:     Window statistics of series answered from prefix tables
+// Author:      Piotr Likus
+// Modified by:
+// Created:     17/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cfloat>
+
+#include "sc/alg/series_window.h"
+
+// ----------------------------------------------------------------------------
+// Local functions
+// ----------------------------------------------------------------------------
+// Neumaier summation step
+static void addCompensated(double &sum, double &correction, double value)
+{
+  const double newSum = sum + value;
+
+  if (fabs(sum) >= fabs(value))
+    correction += (sum - newSum) + value;
+  else
+    correction += (value - newSum) + sum;
+  sum = newSum;
+}
+
+static bool isExtremeValue(double prevVal, double val, double nextVal)
+{
+  return ((prevVal < val) && (val > nextVal)) || ((prevVal > val) && (val < nextVal));
+}
+
+// ----------------------------------------------------------------------------
+// scSeriesWindowStats
+// ----------------------------------------------------------------------------
+scSeriesWindowStats::scSeriesWindowStats(const scVectorOfDouble &input): m_input(input)
+{
+  prepare();
+}
+
+void scSeriesWindowStats::prepare()
+{
+  const uint n = m_input.size();
+  double incSum = 0.0, incCorr = 0.0;
+  double diffSum = 0.0, diffCorr = 0.0;
+  // integers below 2^52: differences and their sums are exact in any order
+  const double exactLimit = 4503599627370496.0;
+
+  m_extremeCount.resize(n + 1);
+  m_increaseSum.resize(n + 1);
+  m_increaseCorr.resize(n + 1);
+  m_extremePos.clear();
+  m_extremeDiffSum.clear();
+  m_extremeDiffCorr.clear();
+
+  m_extremeCount[0] = 0;
+  m_increaseSum[0] = m_increaseCorr[0] = 0.0;
+  m_exactSums = true;
+
+  for(uint i = 0; i != n; i++)
+  {
+    if ((floor(m_input[i]) != m_input[i]) || (fabs(m_input[i]) >= exactLimit))
+      m_exactSums = false;
+
+    m_extremeCount[i + 1] = m_extremeCount[i];
+    if ((i > 0) && (i + 1 < n) && isExtremeValue(m_input[i - 1], m_input[i], m_input[i + 1]))
+    {
+      if (!m_extremePos.empty())
+        addCompensated(diffSum, diffCorr, fabs(m_input[m_extremePos.back()] - m_input[i]));
+      m_extremePos.push_back(i);
+      m_extremeDiffSum.push_back(diffSum);
+      m_extremeDiffCorr.push_back(diffCorr);
+      m_extremeCount[i + 1]++;
+    }
+
+    if ((i > 0) && (m_input[i - 1] < m_input[i]))
+      addCompensated(incSum, incCorr, m_input[i] - m_input[i - 1]);
+    m_increaseSum[i + 1] = incSum;
+    m_increaseCorr[i + 1] = incCorr;
+  }
+
+  if (diffSum >= exactLimit)
+    m_exactSums = false;
+}
+
+uint scSeriesWindowStats::countExtremeValues(int beginPos, int endPos) const
+{
+  if (endPos - beginPos <= 2)
+    return 0;
+  return m_extremeCount[endPos - 1] - m_extremeCount[beginPos + 1];
+}
+
+// first extreme is measured from first sample of window, next ones from previous extreme
+double scSeriesWindowStats::sumExtremeDiffs(int beginPos, int endPos) const
+{
+  if (endPos - beginPos <= 2)
+    return 0.0;
+
+  const uint firstIdx = m_extremeCount[beginPos + 1];
+  const uint endIdx = m_extremeCount[endPos - 1];
+
+  if (firstIdx == endIdx)
+    return 0.0;
+
+  return
+    fabs(m_input[beginPos] - m_input[m_extremePos[firstIdx]]) +
+    ((m_extremeDiffSum[endIdx - 1] - m_extremeDiffSum[firstIdx]) +
+     (m_extremeDiffCorr[endIdx - 1] - m_extremeDiffCorr[firstIdx]));
+}
+
+// Prefix sum differs from direct sum by rounding, which matters only when
+// result is close to integer. Bound covers error of direct sum (one rounding
+// per extreme) and of compensated prefix difference.
+int scSeriesWindowStats::truncExtremeDiffs(int beginPos, int endPos) const
+{
+  const uint count = countExtremeValues(beginPos, endPos);
+
+  // with one extreme prefix part is exactly 0
+  if ((count < 2) || m_exactSums)
+    return static_cast<int>(sumExtremeDiffs(beginPos, endPos));
+
+  const double value = sumExtremeDiffs(beginPos, endPos);
+  const double margin = 8.0 * DBL_EPSILON * 
+    ((count + 2) * value + m_extremeDiffSum[m_extremeCount[endPos - 1] - 1]);
+
+  if (fabs(value - floor(value + 0.5)) > margin)
+    return static_cast<int>(value);
+  return static_cast<int>(::sumExtremeDiffs(m_input, beginPos, endPos));
+}
+
+double scSeriesWindowStats::sumIncreases(int beginPos, int endPos) const
+{
+  if (endPos - beginPos <= 1)
+    return 0.0;
+  return
+    (m_increaseSum[endPos] - m_increaseSum[beginPos + 1]) +
+    (m_increaseCorr[endPos] - m_increaseCorr[beginPos + 1]);
+}